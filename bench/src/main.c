@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Key path benchmark runner
+ *
+ * Prints one JSON line per run for twister to record, followed by the
+ * verdict against the configured budgets.
+ */
+
+#include "kb_bench.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+int main(void)
+{
+	struct kb_bench_result result;
+	int ret;
+
+	ret = kb_bench_run(CONFIG_KEYBOARD_BENCH_ITERATIONS, &result);
+	if (ret) {
+		printk("kb_bench: FAIL (%d)\n", ret);
+		return ret;
+	}
+
+	printk("kb_bench: {\"board\":\"%s\",\"iterations\":%u,"
+	       "\"press_ns\":%u,\"release_ns\":%u,\"report_ns\":%u,"
+	       "\"event_cyc\":%u,\"events_per_sec\":%u,"
+	       "\"queued_ns\":%u,\"direct_ns\":%u,"
+	       "\"keymap\":%s,\"pipeline_cyc\":%u}\n",
+	       CONFIG_BOARD, result.iterations,
+	       result.press_ns, result.release_ns, result.report_ns,
+	       result.event_cyc, result.events_per_sec,
+	       result.queued_ns, result.direct_ns,
+	       IS_ENABLED(CONFIG_KEYBOARD_GENERATED_KEYMAP) ? "true" : "false",
+	       result.pipeline_cyc);
+
+	ret = kb_bench_check(&result);
+	printk("kb_bench: %s\n", ret ? "FAIL" : "PASS");
+
+	return ret;
+}
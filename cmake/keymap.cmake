@@ -0,0 +1,32 @@
+# SPDX-License-Identifier: Apache-2.0
+#
+# Compile CONFIG_KEYBOARD_KEYMAP_FILE into kb_keymap_generated.h with the
+# host tool and add it to the app's include path. Shared by the
+# application and the benchmark.
+
+include(ExternalProject)
+
+set(KEYMAP_COMPILER_DIR ${CMAKE_CURRENT_BINARY_DIR}/keymap_compiler)
+set(KEYMAP_FILE ${APPLICATION_SOURCE_DIR}/${CONFIG_KEYBOARD_KEYMAP_FILE})
+set(KEYMAP_HEADER ${CMAKE_CURRENT_BINARY_DIR}/include/kb_keymap_generated.h)
+file(MAKE_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}/include)
+
+# Host tool, built with the host compiler rather than the cross toolchain
+ExternalProject_Add(keymap_compiler
+  SOURCE_DIR ${CMAKE_CURRENT_LIST_DIR}/../tools/keymap_compiler
+  BINARY_DIR ${KEYMAP_COMPILER_DIR}
+  INSTALL_COMMAND ""
+  BUILD_ALWAYS TRUE
+  BUILD_BYPRODUCTS ${KEYMAP_COMPILER_DIR}/keymap_compiler
+)
+
+add_custom_command(
+  OUTPUT ${KEYMAP_HEADER}
+  COMMAND ${KEYMAP_COMPILER_DIR}/keymap_compiler ${KEYMAP_FILE} ${KEYMAP_HEADER}
+  DEPENDS keymap_compiler ${KEYMAP_FILE}
+  COMMENT "Compiling keymap ${CONFIG_KEYBOARD_KEYMAP_FILE}"
+)
+add_custom_target(kb_keymap_generated DEPENDS ${KEYMAP_HEADER})
+add_dependencies(app kb_keymap_generated)
+
+target_include_directories(app PRIVATE ${CMAKE_CURRENT_BINARY_DIR}/include)
@@ -0,0 +1,288 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+# SPDX-License-Identifier: Apache-2.0
+"""
+End-to-end test bench for the keyboard running on native_sim.
+
+Boots zephyr.exe built with the scripted typing workload, attaches the
+device to the local Linux host over USB/IP, reads the input reports from
+hidraw and matches them against the injected events printed by the
+firmware. Reports injection-to-host latency, report rate and loss. The
+keyboard report layout (report ID, boot key array or NKRO bitmap) is
+read from the device's report descriptor, so every build is decoded.
+
+Needs root (or equivalent permissions) for usbip and the vhci-hcd module:
+
+    west build -b native_sim
+    sudo modprobe vhci-hcd
+    sudo scripts/usbip_bench.py build/zephyr/zephyr.exe
+"""
+
+import argparse
+import glob
+import os
+import re
+import subprocess
+import sys
+import threading
+import time
+
+VID = 0x1209
+PID = 0x0007
+
+# HID usage page of keyboard keys and the short item tags the layout needs
+PAGE_KEYBOARD = 0x07
+ITEM_USAGE_PAGE = 0x04
+ITEM_REPORT_SIZE = 0x74
+ITEM_REPORT_ID = 0x84
+ITEM_REPORT_COUNT = 0x94
+ITEM_INPUT = 0x80
+
+# INPUT_KEY_* codes used by the typing script and their HID usages
+INPUT_TO_HID = {
+    16: 0x14, 17: 0x1A, 18: 0x08, 19: 0x15, 20: 0x17, 21: 0x1C, 22: 0x18,
+    23: 0x0C, 24: 0x12, 25: 0x13, 28: 0x28, 30: 0x04, 31: 0x16, 32: 0x07,
+    33: 0x09, 34: 0x0A, 35: 0x0B, 36: 0x0D, 37: 0x0E, 38: 0x0F, 44: 0x1D,
+    45: 0x1B, 46: 0x06, 47: 0x19, 48: 0x05, 49: 0x11, 50: 0x10, 57: 0x2C,
+}
+
+INJECT_RE = re.compile(r"kb_sim: inject (\d+) (\d+) (-?\d+) (\d+)")
+DONE_RE = re.compile(r"kb_sim: done (\d+)")
+
+
+class Bench:
+    def __init__(self):
+        self.injections = []
+        self.reports = []
+        self.offset_ns = None
+        self.done = threading.Event()
+
+    def read_console(self, stream):
+        for raw in stream:
+            now = time.monotonic_ns()
+            line = raw.decode(errors="replace")
+            match = INJECT_RE.search(line)
+            if match:
+                seq, code, value, uptime_us = map(int, match.groups())
+                self.injections.append((seq, code, value != 0, uptime_us * 1000))
+                # Best estimate of sim uptime zero on the host clock
+                offset = now - uptime_us * 1000
+                if self.offset_ns is None or offset < self.offset_ns:
+                    self.offset_ns = offset
+            elif DONE_RE.search(line):
+                self.done.set()
+
+    def read_hidraw(self, fd, report_id, nkro):
+        while not self.done.is_set():
+            try:
+                data = os.read(fd, 64)
+            except OSError:
+                break
+            now = time.monotonic_ns()
+            if report_id:
+                # Consumer and vendor reports carry no typed keys
+                if not data or data[0] != report_id:
+                    continue
+                data = data[1:]
+            self.reports.append((now, report_keys(data, nkro)))
+
+
+def find_busid(host):
+    out = subprocess.run(["usbip", "list", "-r", host], capture_output=True,
+                         text=True, check=True).stdout
+    match = re.search(r"^\s*(\d+-[\d.]+):.*\(%04x:%04x\)" % (VID, PID), out,
+                      re.MULTILINE)
+    return match.group(1) if match else None
+
+
+def find_port():
+    out = subprocess.run(["usbip", "port"], capture_output=True, text=True,
+                         check=False).stdout
+    for block in re.split(r"(?=^Port )", out, flags=re.MULTILINE):
+        if "%04x:%04x" % (VID, PID) in block:
+            return re.match(r"Port (\d+)", block).group(1)
+    return None
+
+
+def find_hidraw():
+    hid_id = "HID_ID=0003:%08X:%08X" % (VID, PID)
+    for node in sorted(glob.glob("/sys/class/hidraw/hidraw*")):
+        with open(os.path.join(node, "device", "uevent")) as f:
+            if hid_id in f.read():
+                return "/dev/" + os.path.basename(node)
+    return None
+
+
+def report_layout(hidraw):
+    """Return the keyboard report ID, 0 without IDs, and whether its keys
+    are a bitmap (NKRO) rather than the boot layout key array."""
+    node = os.path.join("/sys/class/hidraw", os.path.basename(hidraw),
+                        "device", "report_descriptor")
+    with open(node, "rb") as f:
+        desc = f.read()
+
+    page = size = count = report_id = 0
+    kbd_id = None
+    nkro = False
+    i = 0
+    while i < len(desc):
+        prefix = desc[i]
+        if prefix == 0xFE:
+            # Long item, never used by the firmware
+            i += 3 + desc[i + 1]
+            continue
+        n = (0, 1, 2, 4)[prefix & 0x03]
+        value = int.from_bytes(desc[i + 1:i + 1 + n], "little")
+        tag = prefix & 0xFC
+        if tag == ITEM_USAGE_PAGE:
+            page = value
+        elif tag == ITEM_REPORT_SIZE:
+            size = value
+        elif tag == ITEM_REPORT_COUNT:
+            count = value
+        elif tag == ITEM_REPORT_ID:
+            report_id = value
+        elif tag == ITEM_INPUT and page == PAGE_KEYBOARD:
+            if kbd_id is None:
+                kbd_id = report_id
+            # The modifiers are 8 one-bit fields, the NKRO keys many more
+            if report_id == kbd_id and size == 1 and count > 8:
+                nkro = True
+        i += 1 + n
+
+    return kbd_id or 0, nkro
+
+
+def report_keys(data, nkro):
+    """Usages held in a keyboard report without its ID, modifiers included."""
+    if nkro:
+        keys = {byte * 8 + bit for byte, bits in enumerate(data[1:17])
+                for bit in range(8) if bits & (1 << bit)}
+        keys.discard(0)
+    else:
+        keys = {k for k in data[2:8] if k}
+    keys |= {0xE0 + bit for bit in range(8) if data[0] & (1 << bit)}
+    return keys
+
+
+def transitions(reports):
+    """Turn keyboard reports into (time, usage, pressed) transitions."""
+    result = []
+    duplicates = 0
+    prev = set()
+    for t, keys in reports:
+        if keys == prev:
+            duplicates += 1
+        for usage in sorted(keys - prev):
+            result.append((t, usage, True))
+        for usage in sorted(prev - keys):
+            result.append((t, usage, False))
+        prev = keys
+    return result, duplicates
+
+
+def percentile(values, pct):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * pct / 100))]
+
+
+def summarize(bench):
+    trans, duplicates = transitions(bench.reports)
+    latencies = []
+    lost = 0
+    pos = 0
+
+    for _, code, pressed, uptime_ns in bench.injections:
+        usage = INPUT_TO_HID.get(code)
+        inject_ns = bench.offset_ns + uptime_ns
+        for i in range(pos, len(trans)):
+            t, u, p = trans[i]
+            if u == usage and p == pressed and t >= inject_ns:
+                latencies.append(t - inject_ns)
+                pos = i + 1
+                break
+        else:
+            lost += 1
+
+    print("injected events:  %d" % len(bench.injections))
+    print("keyboard reports: %d (%d without change)" %
+          (len(bench.reports), duplicates))
+    print("lost transitions: %d" % lost)
+
+    if len(bench.reports) > 1:
+        span = bench.reports[-1][0] - bench.reports[0][0]
+        print("report rate:      %.1f reports/s" %
+              ((len(bench.reports) - 1) * 1e9 / span))
+
+    if latencies:
+        print("latency (us):     min %.0f avg %.0f p99 %.0f max %.0f" %
+              (min(latencies) / 1e3, sum(latencies) / len(latencies) / 1e3,
+               percentile(latencies, 99) / 1e3, max(latencies) / 1e3))
+
+    return 1 if lost else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("exe", help="path to zephyr.exe")
+    parser.add_argument("--host", default="127.0.0.1", help="USB/IP server address")
+    parser.add_argument("--attach-timeout", type=float, default=10.0,
+                        help="seconds to wait for the device to appear")
+    parser.add_argument("--timeout", type=float, default=120.0,
+                        help="seconds to wait for the workload to finish")
+    args = parser.parse_args()
+
+    bench = Bench()
+    sim = subprocess.Popen([args.exe], stdout=subprocess.PIPE,
+                           stderr=subprocess.STDOUT)
+    threading.Thread(target=bench.read_console, args=(sim.stdout,),
+                     daemon=True).start()
+
+    busid = None
+    hidraw = None
+    try:
+        deadline = time.monotonic() + args.attach_timeout
+        while busid is None and time.monotonic() < deadline:
+            time.sleep(0.5)
+            busid = find_busid(args.host)
+        if busid is None:
+            sys.exit("device not exported over USB/IP")
+
+        subprocess.run(["usbip", "attach", "-r", args.host, "-b", busid],
+                       check=True)
+
+        while hidraw is None and time.monotonic() < deadline + args.attach_timeout:
+            time.sleep(0.2)
+            hidraw = find_hidraw()
+        if hidraw is None:
+            sys.exit("no hidraw node for %04x:%04x" % (VID, PID))
+
+        report_id, nkro = report_layout(hidraw)
+        print("keyboard report:  %s, %s" %
+              ("ID %d" % report_id if report_id else "no ID",
+               "NKRO bitmap" if nkro else "boot layout"))
+
+        fd = os.open(hidraw, os.O_RDONLY)
+        reader = threading.Thread(target=bench.read_hidraw,
+                                  args=(fd, report_id, nkro), daemon=True)
+        reader.start()
+
+        if not bench.done.wait(args.timeout):
+            print("workload did not finish in time", file=sys.stderr)
+        # Let the last reports arrive
+        time.sleep(0.5)
+        bench.done.set()
+        os.close(fd)
+    finally:
+        port = find_port() if busid is not None else None
+        if port is not None:
+            subprocess.run(["usbip", "detach", "-p", port], check=False)
+        sim.terminate()
+        sim.wait()
+
+    sys.exit(summarize(bench))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,554 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Analog hall-effect keys with adjustable actuation and rapid trigger
+ *
+ * Every multiplexer output is an ADC channel. One ADC sequence samples
+ * all channels at once, moved by DMA where the driver supports it, and
+ * the sequence callback, in the ADC interrupt, copies the samples into
+ * the current frame, selects the next multiplexer address and asks for
+ * the same sampling again. The ADC therefore runs continuously, one
+ * sampling per address every settle-time-us, and never returns to the
+ * application. After the last address the frame buffers are swapped and
+ * the processing thread is woken.
+ *
+ * Processing is integer only. Travel is the distance from the learnt
+ * rest level scaled by the widest deflection seen so far, in
+ * micrometres. The rest level is learnt over the first frames and then
+ * follows slow drift while the key is up. Changes are reported through
+ * the input subsystem as matrix positions, like gpio-kbd-matrix, so the
+ * generated keymap and the rest of the pipeline handle them unchanged.
+ * Each change is stamped with the completion of the frame it was seen
+ * in, taken in the ADC interrupt.
+ */
+
+#include "kb_analog.h"
+#include "kb_stamp.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/input/input.h>
+#include <zephyr/linker/section_tags.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(kb_analog, CONFIG_KEYBOARD_LOG_LEVEL);
+
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(analog_hall_keys) == 1,
+	     "Exactly one analog-hall-keys node is supported");
+
+#define ANALOG_COLUMNS DT_PROP(KB_ANALOG_NODE, columns)
+#define ANALOG_SETTLE_US DT_PROP(KB_ANALOG_NODE, settle_time_us)
+#define ANALOG_TRAVEL_UM DT_PROP(KB_ANALOG_NODE, travel_um)
+#define ANALOG_HYSTERESIS_UM DT_PROP(KB_ANALOG_NODE, hysteresis_um)
+#define ANALOG_DEADZONE_UM DT_PROP(KB_ANALOG_NODE, deadzone_um)
+#define ANALOG_DEFAULT_RANGE DT_PROP(KB_ANALOG_NODE, default_range)
+#define ANALOG_INVERTED DT_PROP(KB_ANALOG_NODE, inverted)
+
+BUILD_ASSERT(ANALOG_TRAVEL_UM <= UINT16_MAX / 2, "travel-um too large");
+BUILD_ASSERT(ANALOG_DEFAULT_RANGE > 0, "default-range must be positive");
+
+/* Frames averaged into the rest level */
+#define ANALOG_CAL_FRAMES 64
+/* Fraction bits of the rest level */
+#define ANALOG_REST_BITS 12
+/* The rest level moves 1/1024 of the difference per frame */
+#define ANALOG_REST_TRACK (1 << 10)
+
+struct analog_key {
+	int32_t rest;
+	uint16_t range;
+	uint16_t raw;
+	uint16_t travel_um;
+	/* Deepest travel while pressed, highest while released */
+	uint16_t extreme_um;
+	uint16_t actuation_um;
+	uint16_t rapid_um;
+	bool pressed;
+	/* Released by rapid trigger, pressed again by moving down */
+	bool rapid_armed;
+};
+
+#define ANALOG_ADC_SPEC(node_id, prop, idx) ADC_DT_SPEC_GET_BY_IDX(node_id, idx),
+#define ANALOG_MUX_SPEC(node_id, prop, idx) GPIO_DT_SPEC_GET_BY_IDX(node_id, prop, idx),
+
+static const struct adc_dt_spec analog_channels[] = {
+	DT_FOREACH_PROP_ELEM(KB_ANALOG_NODE, io_channels, ANALOG_ADC_SPEC)
+};
+
+static const struct gpio_dt_spec analog_mux[] = {
+	DT_FOREACH_PROP_ELEM(KB_ANALOG_NODE, mux_gpios, ANALOG_MUX_SPEC)
+};
+
+static struct analog_key analog_keys[KB_ANALOG_KEYS];
+static struct k_spinlock analog_lock;
+
+/* Written by the ADC, DMA capable memory */
+static __nocache uint16_t analog_sample[KB_ANALOG_CHANNELS];
+/* Indexed by channel * KB_ANALOG_ADDRS + address, like the keys */
+static uint16_t analog_frames[2][KB_ANALOG_KEYS];
+static volatile uint8_t analog_fill;
+/* kb_stamp() when each frame buffer was completed */
+static uint32_t analog_frame_at[2];
+static uint16_t analog_addr;
+static K_SEM_DEFINE(analog_frame_sem, 0, 1);
+
+static uint32_t analog_frame_start;
+static uint32_t analog_frame_cyc;
+static uint32_t analog_frame_count;
+static uint32_t analog_overruns;
+
+static atomic_t analog_recalibrate = ATOMIC_INIT(1);
+static uint32_t analog_cal_left;
+static uint32_t analog_cal_sum[KB_ANALOG_KEYS];
+
+static struct adc_sequence_options analog_options;
+static struct adc_sequence analog_seq;
+
+static void analog_select(uint16_t addr)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(analog_mux); i++) {
+		gpio_pin_set_dt(&analog_mux[i], (addr >> i) & 1U);
+	}
+}
+
+/* ADC interrupt, after every sampling of all channels */
+static enum adc_action analog_sampled(const struct device *adc,
+				      const struct adc_sequence *seq,
+				      uint16_t sampling_index)
+{
+	uint16_t *frame = analog_frames[analog_fill];
+	uint32_t now;
+
+	ARG_UNUSED(adc);
+	ARG_UNUSED(seq);
+	ARG_UNUSED(sampling_index);
+
+	for (size_t ch = 0; ch < KB_ANALOG_CHANNELS; ch++) {
+		frame[ch * KB_ANALOG_ADDRS + analog_addr] = analog_sample[ch];
+	}
+
+	analog_addr = (analog_addr + 1U) % KB_ANALOG_ADDRS;
+	analog_select(analog_addr);
+
+	if (analog_addr == 0U) {
+		now = kb_stamp();
+		analog_frame_cyc = now - analog_frame_start;
+		analog_frame_start = now;
+		analog_frame_count++;
+		analog_frame_at[analog_fill] = now;
+		analog_fill ^= 1U;
+
+		if (k_sem_count_get(&analog_frame_sem) != 0U) {
+			analog_overruns++;
+		}
+		k_sem_give(&analog_frame_sem);
+	}
+
+	/* Sample again into the same buffer, after the settle interval */
+	return ADC_ACTION_REPEAT;
+}
+
+static void analog_report(const struct device *dev, uint16_t n, bool pressed,
+			  uint32_t stamp)
+{
+	kb_stamp_report(dev, stamp);
+	input_report_abs(dev, INPUT_ABS_X, n % ANALOG_COLUMNS, false, K_FOREVER);
+	input_report_abs(dev, INPUT_ABS_Y, n / ANALOG_COLUMNS, false, K_FOREVER);
+	input_report_key(dev, INPUT_BTN_TOUCH, pressed, true, K_FOREVER);
+}
+
+/* Update one key from its sample, true if it was pressed or released */
+static bool analog_key_update(struct analog_key *key, uint16_t raw)
+{
+	int32_t delta = ((int32_t)raw << ANALOG_REST_BITS) - key->rest;
+	uint32_t travel = 0;
+	uint32_t counts;
+	bool pressed;
+
+	key->raw = raw;
+
+	if (ANALOG_INVERTED) {
+		delta = -delta;
+	}
+
+	if (delta > 0) {
+		counts = delta >> ANALOG_REST_BITS;
+		if (counts > key->range) {
+			/* Deeper than any press before, widen the range */
+			key->range = MIN(counts, UINT16_MAX);
+		}
+		travel = counts * ANALOG_TRAVEL_UM / key->range;
+	}
+
+	key->travel_um = travel;
+
+	if (travel < ANALOG_DEADZONE_UM) {
+		pressed = false;
+		key->rapid_armed = false;
+		if (!key->pressed) {
+			key->rest += (((int32_t)raw << ANALOG_REST_BITS) - key->rest) /
+				     ANALOG_REST_TRACK;
+		}
+	} else if (key->pressed) {
+		if (key->rapid_um != 0U) {
+			pressed = travel + key->rapid_um > key->extreme_um;
+		} else {
+			pressed = travel + ANALOG_HYSTERESIS_UM >= key->actuation_um;
+		}
+	} else if (key->rapid_armed) {
+		/* Below the actuation point too, until the key is let up fully */
+		pressed = travel >= key->extreme_um + key->rapid_um;
+	} else {
+		pressed = travel >= key->actuation_um;
+	}
+
+	if (pressed != key->pressed) {
+		key->pressed = pressed;
+		key->extreme_um = travel;
+		key->rapid_armed = !pressed && key->rapid_um != 0U &&
+				   travel >= ANALOG_DEADZONE_UM;
+		return true;
+	}
+
+	key->extreme_um = pressed ? MAX(key->extreme_um, travel) :
+				    MIN(key->extreme_um, travel);
+
+	return false;
+}
+
+static void analog_calibrate_start(const struct device *dev)
+{
+	bool released[KB_ANALOG_KEYS];
+	k_spinlock_key_t lock = k_spin_lock(&analog_lock);
+
+	for (uint16_t n = 0; n < KB_ANALOG_KEYS; n++) {
+		released[n] = analog_keys[n].pressed;
+		analog_keys[n].pressed = false;
+		analog_keys[n].rapid_armed = false;
+		analog_keys[n].travel_um = 0;
+		analog_keys[n].range = ANALOG_DEFAULT_RANGE;
+	}
+
+	memset(analog_cal_sum, 0, sizeof(analog_cal_sum));
+	analog_cal_left = ANALOG_CAL_FRAMES;
+	k_spin_unlock(&analog_lock, lock);
+
+	for (uint16_t n = 0; n < KB_ANALOG_KEYS; n++) {
+		if (released[n]) {
+			analog_report(dev, n, false, kb_stamp());
+		}
+	}
+}
+
+static void analog_calibrate_frame(const uint16_t *frame)
+{
+	k_spinlock_key_t lock = k_spin_lock(&analog_lock);
+
+	for (uint16_t n = 0; n < KB_ANALOG_KEYS; n++) {
+		analog_cal_sum[n] += frame[n];
+		analog_keys[n].raw = frame[n];
+	}
+
+	if (--analog_cal_left == 0U) {
+		for (uint16_t n = 0; n < KB_ANALOG_KEYS; n++) {
+			analog_keys[n].rest = ((int64_t)analog_cal_sum[n] << ANALOG_REST_BITS) /
+					      ANALOG_CAL_FRAMES;
+		}
+		LOG_INF("Calibrated %u keys", KB_ANALOG_KEYS);
+	}
+
+	k_spin_unlock(&analog_lock, lock);
+}
+
+static void analog_thread(void *p1, void *p2, void *p3)
+{
+	const struct device *dev = p1;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		const uint16_t *frame;
+		uint32_t stamp;
+
+		k_sem_take(&analog_frame_sem, K_FOREVER);
+		frame = analog_frames[analog_fill ^ 1U];
+		stamp = analog_frame_at[analog_fill ^ 1U];
+
+		if (atomic_cas(&analog_recalibrate, 1, 0)) {
+			analog_calibrate_start(dev);
+		}
+
+		if (analog_cal_left != 0U) {
+			analog_calibrate_frame(frame);
+			continue;
+		}
+
+		for (uint16_t n = 0; n < KB_ANALOG_KEYS; n++) {
+			k_spinlock_key_t lock = k_spin_lock(&analog_lock);
+			bool changed = analog_key_update(&analog_keys[n], frame[n]);
+			bool pressed = analog_keys[n].pressed;
+
+			k_spin_unlock(&analog_lock, lock);
+
+			if (changed) {
+				analog_report(dev, n, pressed, stamp);
+			}
+		}
+	}
+}
+
+K_THREAD_STACK_DEFINE(analog_stack, CONFIG_KEYBOARD_ANALOG_STACK_SIZE);
+static struct k_thread analog_thread_data;
+
+int kb_analog_get(uint16_t key, struct kb_analog_key *state)
+{
+	k_spinlock_key_t lock;
+
+	if (key >= KB_ANALOG_KEYS) {
+		return -EINVAL;
+	}
+
+	lock = k_spin_lock(&analog_lock);
+	state->raw = analog_keys[key].raw;
+	state->rest = analog_keys[key].rest >> ANALOG_REST_BITS;
+	state->range = analog_keys[key].range;
+	state->travel_um = analog_keys[key].travel_um;
+	state->actuation_um = analog_keys[key].actuation_um;
+	state->rapid_um = analog_keys[key].rapid_um;
+	state->pressed = analog_keys[key].pressed;
+	k_spin_unlock(&analog_lock, lock);
+
+	return 0;
+}
+
+static int analog_set(uint16_t key, uint16_t um, bool rapid)
+{
+	uint16_t first = key == KB_ANALOG_ALL_KEYS ? 0 : key;
+	uint16_t last = key == KB_ANALOG_ALL_KEYS ? KB_ANALOG_KEYS - 1 : key;
+	k_spinlock_key_t lock;
+
+	if (first >= KB_ANALOG_KEYS || um > ANALOG_TRAVEL_UM ||
+	    (!rapid && um < ANALOG_DEADZONE_UM)) {
+		return -EINVAL;
+	}
+
+	lock = k_spin_lock(&analog_lock);
+	for (uint16_t n = first; n <= last; n++) {
+		if (rapid) {
+			analog_keys[n].rapid_um = um;
+			analog_keys[n].rapid_armed = false;
+		} else {
+			analog_keys[n].actuation_um = um;
+		}
+	}
+	k_spin_unlock(&analog_lock, lock);
+
+	return 0;
+}
+
+int kb_analog_set_actuation(uint16_t key, uint16_t um)
+{
+	return analog_set(key, um, false);
+}
+
+int kb_analog_set_rapid_trigger(uint16_t key, uint16_t um)
+{
+	return analog_set(key, um, true);
+}
+
+void kb_analog_calibrate(void)
+{
+	atomic_set(&analog_recalibrate, 1);
+}
+
+void kb_analog_stats_get(struct kb_analog_stats *stats)
+{
+	stats->frames = analog_frame_count;
+	stats->overruns = analog_overruns;
+	stats->frame_us = k_cyc_to_us_floor32(analog_frame_cyc);
+}
+
+static int analog_init(const struct device *dev)
+{
+	const struct device *adc = analog_channels[0].dev;
+	int ret;
+
+	for (size_t i = 0; i < ARRAY_SIZE(analog_channels); i++) {
+		if (analog_channels[i].dev != adc) {
+			LOG_ERR("All channels must be on one ADC");
+			return -EINVAL;
+		}
+
+		if (!adc_is_ready_dt(&analog_channels[i])) {
+			LOG_ERR("ADC %s is not ready", adc->name);
+			return -ENODEV;
+		}
+
+		ret = adc_channel_setup_dt(&analog_channels[i]);
+		if (ret) {
+			LOG_ERR("Failed to set up channel %u, %d",
+				analog_channels[i].channel_id, ret);
+			return ret;
+		}
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(analog_mux); i++) {
+		if (!gpio_is_ready_dt(&analog_mux[i])) {
+			LOG_ERR("Multiplexer GPIO is not ready");
+			return -ENODEV;
+		}
+
+		ret = gpio_pin_configure_dt(&analog_mux[i], GPIO_OUTPUT_INACTIVE);
+		if (ret) {
+			return ret;
+		}
+	}
+
+	for (uint16_t n = 0; n < KB_ANALOG_KEYS; n++) {
+		analog_keys[n].range = ANALOG_DEFAULT_RANGE;
+		analog_keys[n].actuation_um = DT_PROP(KB_ANALOG_NODE, actuation_um);
+		analog_keys[n].rapid_um = DT_PROP(KB_ANALOG_NODE, rapid_trigger_um);
+	}
+
+	k_thread_create(&analog_thread_data, analog_stack,
+			K_THREAD_STACK_SIZEOF(analog_stack), analog_thread,
+			(void *)dev, NULL, NULL,
+			CONFIG_KEYBOARD_ANALOG_PRIORITY, 0, K_NO_WAIT);
+	k_thread_name_set(&analog_thread_data, "kb_analog");
+
+	analog_options.interval_us = ANALOG_SETTLE_US;
+	analog_options.callback = analog_sampled;
+
+	adc_sequence_init_dt(&analog_channels[0], &analog_seq);
+	for (size_t i = 1; i < ARRAY_SIZE(analog_channels); i++) {
+		analog_seq.channels |= BIT(analog_channels[i].channel_id);
+	}
+	analog_seq.options = &analog_options;
+	analog_seq.buffer = analog_sample;
+	analog_seq.buffer_size = sizeof(analog_sample);
+
+	analog_addr = 0;
+	analog_frame_start = k_cycle_get_32();
+
+	ret = adc_read_async(adc, &analog_seq, NULL);
+	if (ret) {
+		LOG_ERR("Failed to start sampling, %d", ret);
+	}
+
+	return ret;
+}
+
+DEVICE_DT_DEFINE(KB_ANALOG_NODE, analog_init, NULL, NULL, NULL,
+		 APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY, NULL);
+
+#ifdef CONFIG_KEYBOARD_SHELL
+static int analog_parse_key(const struct shell *sh, size_t argc, char **argv,
+			    uint16_t *key)
+{
+	if (argc < 3 || strcmp(argv[2], "all") == 0) {
+		*key = KB_ANALOG_ALL_KEYS;
+		return 0;
+	}
+
+	*key = strtoul(argv[2], NULL, 0);
+	if (*key >= KB_ANALOG_KEYS) {
+		shell_error(sh, "Key must be below %u", KB_ANALOG_KEYS);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int cmd_analog_show(const struct shell *sh, size_t argc, char **argv)
+{
+	bool all = argc > 1 && strcmp(argv[1], "all") == 0;
+	struct kb_analog_stats stats;
+	struct kb_analog_key key;
+
+	kb_analog_stats_get(&stats);
+	shell_print(sh, "frames %u, %u us each, overruns %u",
+		    stats.frames, stats.frame_us, stats.overruns);
+
+	for (uint16_t n = 0; n < KB_ANALOG_KEYS; n++) {
+		kb_analog_get(n, &key);
+		if (!all && key.travel_um == 0U) {
+			continue;
+		}
+
+		shell_print(sh, "%3u raw %5u rest %5u range %5u travel %4u um "
+			    "act %4u rt %4u %s", n, key.raw, key.rest, key.range,
+			    key.travel_um, key.actuation_um, key.rapid_um,
+			    key.pressed ? "down" : "up");
+	}
+
+	return 0;
+}
+
+static int cmd_analog_actuation(const struct shell *sh, size_t argc, char **argv)
+{
+	uint16_t key;
+	int ret;
+
+	ret = analog_parse_key(sh, argc, argv, &key);
+	if (ret) {
+		return ret;
+	}
+
+	ret = kb_analog_set_actuation(key, strtoul(argv[1], NULL, 0));
+	if (ret) {
+		shell_error(sh, "Actuation must be %u..%u um",
+			    ANALOG_DEADZONE_UM, ANALOG_TRAVEL_UM);
+	}
+
+	return ret;
+}
+
+static int cmd_analog_rapid(const struct shell *sh, size_t argc, char **argv)
+{
+	uint16_t key;
+	int ret;
+
+	ret = analog_parse_key(sh, argc, argv, &key);
+	if (ret) {
+		return ret;
+	}
+
+	ret = kb_analog_set_rapid_trigger(key, strtoul(argv[1], NULL, 0));
+	if (ret) {
+		shell_error(sh, "Sensitivity must be 0..%u um", ANALOG_TRAVEL_UM);
+	}
+
+	return ret;
+}
+
+static int cmd_analog_calibrate(const struct shell *sh, size_t argc, char **argv)
+{
+	kb_analog_calibrate();
+	shell_print(sh, "Release all keys, learning rest levels");
+
+	return 0;
+}
+
+SHELL_SUBCMD_SET_CREATE(kb_analog_cmds, (kb, analog));
+SHELL_SUBCMD_ADD((kb, analog), show, NULL,
+		 "Show keys with travel and the scan rate [all]",
+		 cmd_analog_show, 1, 1);
+SHELL_SUBCMD_ADD((kb, analog), actuation, NULL,
+		 "Set the actuation point <um> [key|all]",
+		 cmd_analog_actuation, 2, 1);
+SHELL_SUBCMD_ADD((kb, analog), rapid, NULL,
+		 "Set the rapid trigger sensitivity, 0 disables <um> [key|all]",
+		 cmd_analog_rapid, 2, 1);
+SHELL_SUBCMD_ADD((kb, analog), calibrate, NULL,
+		 "Learn the rest levels again",
+		 cmd_analog_calibrate, 1, 0);
+SHELL_SUBCMD_ADD((kb), analog, &kb_analog_cmds, "Analog keys", NULL, 1, 0);
+#endif /* CONFIG_KEYBOARD_SHELL */
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Analog hall-effect keys with adjustable actuation and rapid trigger
+ */
+
+#ifndef KEYBOARD_KB_ANALOG_H
+#define KEYBOARD_KB_ANALOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/util.h>
+
+#define KB_ANALOG_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(analog_hall_keys)
+
+/* Multiplexer outputs, one ADC channel each */
+#define KB_ANALOG_CHANNELS DT_PROP_LEN(KB_ANALOG_NODE, io_channels)
+/* Multiplexer inputs, selected by the address lines */
+#define KB_ANALOG_ADDRS BIT(DT_PROP_LEN(KB_ANALOG_NODE, mux_gpios))
+#define KB_ANALOG_KEYS (KB_ANALOG_CHANNELS * KB_ANALOG_ADDRS)
+
+/* Key argument of the setters applying to every key */
+#define KB_ANALOG_ALL_KEYS UINT16_MAX
+
+struct kb_analog_key {
+	/* Last raw sample and the learnt calibration, in ADC counts */
+	uint16_t raw;
+	uint16_t rest;
+	uint16_t range;
+	/* Travel from rest and thresholds, in micrometres */
+	uint16_t travel_um;
+	uint16_t actuation_um;
+	uint16_t rapid_um;
+	bool pressed;
+};
+
+struct kb_analog_stats {
+	/* Complete scans of every multiplexer address */
+	uint32_t frames;
+	/* Frames overwritten before they were processed */
+	uint32_t overruns;
+	/* Duration of the last frame */
+	uint32_t frame_us;
+};
+
+/*
+ * Get the state of one key.
+ *
+ * @param key Key index, multiplexer input plus channel times KB_ANALOG_ADDRS
+ * @param state Set to the key state
+ * @return 0 on success, -EINVAL for an unknown key
+ */
+int kb_analog_get(uint16_t key, struct kb_analog_key *state);
+
+/*
+ * Set the actuation point.
+ *
+ * @param key Key index or KB_ANALOG_ALL_KEYS
+ * @param um Travel from rest, deadzone to full travel
+ * @return 0 on success, -EINVAL for an unknown key or travel
+ */
+int kb_analog_set_actuation(uint16_t key, uint16_t um);
+
+/*
+ * Set the rapid trigger sensitivity.
+ *
+ * @param key Key index or KB_ANALOG_ALL_KEYS
+ * @param um Movement that releases or presses the key again, 0 to disable
+ * @return 0 on success, -EINVAL for an unknown key or travel
+ */
+int kb_analog_set_rapid_trigger(uint16_t key, uint16_t um);
+
+/* Forget the calibration and learn the rest levels again */
+void kb_analog_calibrate(void);
+
+void kb_analog_stats_get(struct kb_analog_stats *stats);
+
+#endif /* KEYBOARD_KB_ANALOG_H */
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Travel curve playback for analog keys on the ADC emulator
+ *
+ * Every channel of the emulated ADC gets a value function. It reads
+ * the multiplexer address back from the emulated GPIO outputs, finds
+ * the key sampled through that address and returns the sensor output
+ * of the key's curve at the current time, or its rest level. Curves are
+ * sensor traces of one key press in millivolts, one point every
+ * EMUL_STEP_MS, so the driver sees the same sampled movement every run.
+ */
+
+#include "kb_analog.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/drivers/adc/adc_emul.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/init.h>
+#include <zephyr/shell/shell.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(kb_analog_emul, CONFIG_KEYBOARD_LOG_LEVEL);
+
+#define EMUL_STEP_MS 2
+/* Sensor output of a key at rest */
+#define EMUL_REST_MV 600
+
+/* Full press and release at typing speed */
+static const uint16_t curve_tap[] = {
+	600, 602, 640, 720, 830, 960, 1090, 1210, 1320, 1410, 1480, 1540,
+	1580, 1600, 1602, 1600, 1598, 1560, 1480, 1370, 1240, 1100, 960,
+	830, 720, 650, 612, 602, 600,
+};
+
+/* Held at the bottom, lifted 0.6 mm and pressed again, three times */
+static const uint16_t curve_flutter[] = {
+	600, 640, 760, 920, 1080, 1240, 1380, 1500, 1580, 1600, 1600, 1560,
+	1480, 1440, 1430, 1460, 1530, 1590, 1600, 1570, 1490, 1440, 1440,
+	1500, 1580, 1600, 1600, 1550, 1470, 1430, 1450, 1520, 1590, 1600,
+	1590, 1480, 1300, 1080, 860, 700, 620, 600,
+};
+
+/* Pressed to 1 mm, short of the default actuation point */
+static const uint16_t curve_tease[] = {
+	600, 610, 640, 690, 750, 800, 840, 850, 852, 850, 840, 800, 740,
+	680, 630, 606, 600,
+};
+
+struct emul_curve {
+	const char *name;
+	const uint16_t *mv;
+	size_t len;
+};
+
+static const struct emul_curve emul_curves[] = {
+	{ "tap", curve_tap, ARRAY_SIZE(curve_tap) },
+	{ "flutter", curve_flutter, ARRAY_SIZE(curve_flutter) },
+	{ "tease", curve_tease, ARRAY_SIZE(curve_tease) },
+};
+
+struct emul_key {
+	const struct emul_curve *curve;
+	int64_t start_ms;
+	/* Held output when no curve plays */
+	uint16_t hold_mv;
+};
+
+#define EMUL_ADC_SPEC(node_id, prop, idx) ADC_DT_SPEC_GET_BY_IDX(node_id, idx),
+#define EMUL_MUX_SPEC(node_id, prop, idx) GPIO_DT_SPEC_GET_BY_IDX(node_id, prop, idx),
+
+static const struct adc_dt_spec emul_channels[] = {
+	DT_FOREACH_PROP_ELEM(KB_ANALOG_NODE, io_channels, EMUL_ADC_SPEC)
+};
+
+static const struct gpio_dt_spec emul_mux[] = {
+	DT_FOREACH_PROP_ELEM(KB_ANALOG_NODE, mux_gpios, EMUL_MUX_SPEC)
+};
+
+static struct emul_key emul_keys[KB_ANALOG_KEYS];
+
+static uint16_t emul_key_mv(struct emul_key *key)
+{
+	const struct emul_curve *curve = key->curve;
+	int64_t step;
+
+	if (curve == NULL) {
+		return key->hold_mv;
+	}
+
+	step = (k_uptime_get() - key->start_ms) / EMUL_STEP_MS;
+	if (step < curve->len) {
+		return curve->mv[step];
+	}
+
+	key->curve = NULL;
+	key->hold_mv = curve->mv[curve->len - 1];
+
+	return key->hold_mv;
+}
+
+/* Called by the ADC emulator for every sample of one channel */
+static int emul_value(const struct device *adc, unsigned int chan, void *data,
+		      uint32_t *result)
+{
+	uintptr_t ch = (uintptr_t)data;
+	uint16_t addr = 0;
+
+	ARG_UNUSED(adc);
+	ARG_UNUSED(chan);
+
+	for (size_t i = 0; i < ARRAY_SIZE(emul_mux); i++) {
+		if (gpio_emul_output_get(emul_mux[i].port, emul_mux[i].pin) > 0) {
+			addr |= BIT(i);
+		}
+	}
+
+	*result = emul_key_mv(&emul_keys[ch * KB_ANALOG_ADDRS + addr]);
+
+	return 0;
+}
+
+static int emul_init(void)
+{
+	int ret;
+
+	for (uint16_t n = 0; n < KB_ANALOG_KEYS; n++) {
+		emul_keys[n].hold_mv = EMUL_REST_MV;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(emul_channels); i++) {
+		ret = adc_emul_value_func_set(emul_channels[i].dev,
+					      emul_channels[i].channel_id,
+					      emul_value, (void *)i);
+		if (ret) {
+			LOG_ERR("Failed to feed channel %u, %d",
+				emul_channels[i].channel_id, ret);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/* Before the analog keys start sampling at the application level */
+SYS_INIT(emul_init, POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY);
+
+static int cmd_emul_play(const struct shell *sh, size_t argc, char **argv)
+{
+	const struct emul_curve *curve = NULL;
+	uint16_t key = strtoul(argv[1], NULL, 0);
+
+	if (key >= KB_ANALOG_KEYS) {
+		shell_error(sh, "Key must be below %u", KB_ANALOG_KEYS);
+		return -EINVAL;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(emul_curves); i++) {
+		if (strcmp(argv[2], emul_curves[i].name) == 0) {
+			curve = &emul_curves[i];
+		}
+	}
+
+	if (curve == NULL) {
+		shell_error(sh, "Unknown curve %s", argv[2]);
+		return -EINVAL;
+	}
+
+	emul_keys[key].start_ms = k_uptime_get();
+	emul_keys[key].curve = curve;
+	shell_print(sh, "Key %u plays %s, %u ms", key, curve->name,
+		    curve->len * EMUL_STEP_MS);
+
+	return 0;
+}
+
+static int cmd_emul_hold(const struct shell *sh, size_t argc, char **argv)
+{
+	uint16_t key = strtoul(argv[1], NULL, 0);
+
+	if (key >= KB_ANALOG_KEYS) {
+		shell_error(sh, "Key must be below %u", KB_ANALOG_KEYS);
+		return -EINVAL;
+	}
+
+	emul_keys[key].curve = NULL;
+	emul_keys[key].hold_mv = argc > 2 ? strtoul(argv[2], NULL, 0) : EMUL_REST_MV;
+
+	return 0;
+}
+
+SHELL_SUBCMD_ADD((kb, analog), play, NULL,
+		 "Play a travel curve on the ADC emulator <key> <tap|flutter|tease>",
+		 cmd_emul_play, 3, 0);
+SHELL_SUBCMD_ADD((kb, analog), hold, NULL,
+		 "Hold the emulated sensor output <key> [mV]",
+		 cmd_emul_hold, 2, 1);
@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Key-state and report microbenchmarks
+ */
+
+#include "kb_bench.h"
+#include "kb_pipeline.h"
+#include "kb_stamp.h"
+#include "kb_state.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/input/input.h>
+#include <zephyr/shell/shell.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(kb_bench, CONFIG_KEYBOARD_LOG_LEVEL);
+
+/* Two modifiers and more regular keys than fit in a 6KRO report */
+static const uint16_t bench_keys[] = {
+	INPUT_KEY_LEFTSHIFT, INPUT_KEY_A, INPUT_KEY_S, INPUT_KEY_D,
+	INPUT_KEY_F, INPUT_KEY_J, INPUT_KEY_K, INPUT_KEY_L,
+	INPUT_KEY_SEMICOLON, INPUT_KEY_RIGHTALT,
+};
+
+#define BENCH_KEY_COUNT ARRAY_SIZE(bench_keys)
+
+#ifdef CONFIG_KEYBOARD_GENERATED_KEYMAP
+#include "kb_keymap_generated.h"
+
+#define BENCH_POS(row, col) (KB_EVENT_MATRIX | ((row) * KB_KEYMAP_COLS + (col)))
+
+/* Matrix positions of bench_keys in keymap/tkl.keymap */
+static const uint16_t bench_events[] = {
+	BENCH_POS(4, 0), BENCH_POS(3, 1), BENCH_POS(3, 2), BENCH_POS(3, 3),
+	BENCH_POS(3, 4), BENCH_POS(3, 7), BENCH_POS(3, 8), BENCH_POS(3, 9),
+	BENCH_POS(3, 10), BENCH_POS(5, 10),
+};
+#else
+#define bench_events bench_keys
+#endif
+
+BUILD_ASSERT(ARRAY_SIZE(bench_events) == BENCH_KEY_COUNT);
+
+struct bench_event {
+	uint16_t code;
+	bool pressed;
+};
+
+/* Depth one, every put hands over to the consumer */
+K_MSGQ_DEFINE(bench_msgq, sizeof(struct bench_event), 1, 4);
+static K_THREAD_STACK_DEFINE(bench_stack, 1024);
+static struct k_thread bench_thread;
+static struct kb_state bench_state;
+
+#ifdef CONFIG_BOARD_NATIVE_SIM
+/* Host side, see kb_bench_native.c */
+uint64_t kb_bench_native_ns(void);
+
+static inline uint32_t bench_stamp(void)
+{
+	return (uint32_t)kb_bench_native_ns();
+}
+
+static inline uint64_t bench_to_ns(uint64_t ticks)
+{
+	return ticks;
+}
+#else
+static inline uint32_t bench_stamp(void)
+{
+	return k_cycle_get_32();
+}
+
+static inline uint64_t bench_to_ns(uint64_t ticks)
+{
+	return k_cyc_to_ns_floor64(ticks);
+}
+#endif
+
+/* One key event of either engine: state update plus report build */
+static inline void bench_handle(struct kb_state *state, uint16_t code, bool pressed)
+{
+	uint8_t report[KB_REPORT_COUNT];
+
+	(void)kb_state_process(state, code, pressed);
+	kb_state_build_report(state, report);
+}
+
+static void bench_consumer(void *p1, void *p2, void *p3)
+{
+	struct bench_event evt;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		k_msgq_get(&bench_msgq, &evt, K_FOREVER);
+		bench_handle(&bench_state, evt.code, evt.pressed);
+	}
+}
+
+/* Time the press and release of every bench key, queued or direct */
+static uint64_t bench_engine(uint32_t iterations, bool queued)
+{
+	struct bench_event evt;
+	uint64_t ticks = 0;
+	uint32_t start;
+
+	kb_state_reset(&bench_state);
+
+	for (uint32_t n = 0; n < iterations; n++) {
+		start = bench_stamp();
+		for (int p = 1; p >= 0; p--) {
+			for (size_t i = 0; i < BENCH_KEY_COUNT; i++) {
+				evt.code = bench_keys[i];
+				evt.pressed = p;
+				if (queued) {
+					/* The consumer preempts and handles it */
+					(void)k_msgq_put(&bench_msgq, &evt, K_FOREVER);
+				} else {
+					bench_handle(&bench_state, evt.code, evt.pressed);
+				}
+			}
+		}
+		ticks += bench_stamp() - start;
+	}
+
+	return ticks;
+}
+
+static void bench_engines(uint32_t iterations, struct kb_bench_result *result)
+{
+	uint64_t ops = (uint64_t)iterations * BENCH_KEY_COUNT * 2U;
+	int prio = k_thread_priority_get(k_current_get());
+	k_tid_t tid;
+
+	tid = k_thread_create(&bench_thread, bench_stack, K_THREAD_STACK_SIZEOF(bench_stack),
+			      bench_consumer, NULL, NULL, NULL,
+			      MAX(prio - 1, K_HIGHEST_APPLICATION_THREAD_PRIO), 0, K_NO_WAIT);
+	result->queued_ns = bench_to_ns(bench_engine(iterations, true)) / ops;
+	k_thread_abort(tid);
+	k_msgq_purge(&bench_msgq);
+
+	result->direct_ns = bench_to_ns(bench_engine(iterations, false)) / ops;
+}
+
+/* Press and release every bench key through the composed pipeline */
+static uint64_t bench_pipeline(uint32_t iterations)
+{
+	uint8_t report[KB_REPORT_COUNT];
+	uint64_t ticks = 0;
+	/* All keys detected at once, only timed stages look at it */
+	uint32_t stamp = kb_stamp();
+	uint32_t start;
+
+	kb_state_reset(&bench_state);
+
+	for (uint32_t n = 0; n < iterations; n++) {
+		start = bench_stamp();
+		for (int p = 1; p >= 0; p--) {
+			for (size_t i = 0; i < BENCH_KEY_COUNT; i++) {
+				(void)kb_pipeline_process(&bench_state, bench_events[i], p, stamp);
+				kb_state_build_report(&bench_state, report);
+			}
+		}
+		ticks += bench_stamp() - start;
+	}
+
+	return ticks;
+}
+
+int kb_bench_run(uint32_t iterations, struct kb_bench_result *result)
+{
+	uint8_t report[KB_REPORT_COUNT];
+	struct kb_state state;
+	uint64_t press_ticks = 0;
+	uint64_t release_ticks = 0;
+	uint64_t report_ticks = 0;
+	uint64_t ops;
+	uint32_t start;
+
+	if (iterations == 0U) {
+		return -EINVAL;
+	}
+
+	kb_state_reset(&state);
+
+	/* Time whole phases so the clock read cost stays out of the figures */
+	for (uint32_t n = 0; n < iterations; n++) {
+		start = bench_stamp();
+		for (size_t i = 0; i < BENCH_KEY_COUNT; i++) {
+			(void)kb_state_process(&state, bench_keys[i], true);
+		}
+		press_ticks += bench_stamp() - start;
+
+		start = bench_stamp();
+		for (size_t i = 0; i < BENCH_KEY_COUNT; i++) {
+			kb_state_build_report(&state, report);
+		}
+		report_ticks += bench_stamp() - start;
+
+		/* Release in press order, the worst case for the shift */
+		start = bench_stamp();
+		for (size_t i = 0; i < BENCH_KEY_COUNT; i++) {
+			(void)kb_state_process(&state, bench_keys[i], false);
+		}
+		release_ticks += bench_stamp() - start;
+	}
+
+	ops = (uint64_t)iterations * BENCH_KEY_COUNT;
+
+	result->iterations = iterations;
+	result->press_ns = bench_to_ns(press_ticks) / ops;
+	result->release_ns = bench_to_ns(release_ticks) / ops;
+	result->report_ns = bench_to_ns(report_ticks) / ops;
+	result->event_cyc = ((press_ticks + release_ticks) / 2U + report_ticks) / ops;
+
+	/* Guard against a coarse clock rounding everything to zero */
+	result->events_per_sec = NSEC_PER_SEC /
+		MAX(1U, (result->press_ns + result->release_ns) / 2U + result->report_ns);
+
+	bench_engines(iterations, result);
+	result->pipeline_cyc = bench_pipeline(iterations) / (ops * 2U);
+
+	return 0;
+}
+
+int kb_bench_check(const struct kb_bench_result *result)
+{
+	int ret = 0;
+
+	if (CONFIG_KEYBOARD_BENCH_MAX_EVENT_CYCLES != 0 &&
+	    result->event_cyc > CONFIG_KEYBOARD_BENCH_MAX_EVENT_CYCLES) {
+		LOG_ERR("%u cycles/event exceeds budget of %u",
+			result->event_cyc, CONFIG_KEYBOARD_BENCH_MAX_EVENT_CYCLES);
+		ret = -ERANGE;
+	}
+
+	if (CONFIG_KEYBOARD_BENCH_MAX_PIPELINE_CYCLES != 0 &&
+	    result->pipeline_cyc > CONFIG_KEYBOARD_BENCH_MAX_PIPELINE_CYCLES) {
+		LOG_ERR("%u cycles/pipeline event exceeds budget of %u",
+			result->pipeline_cyc, CONFIG_KEYBOARD_BENCH_MAX_PIPELINE_CYCLES);
+		ret = -ERANGE;
+	}
+
+	if (result->events_per_sec < CONFIG_KEYBOARD_BENCH_MIN_EVENTS_PER_SEC) {
+		LOG_ERR("%u events/s is below budget of %u",
+			result->events_per_sec, CONFIG_KEYBOARD_BENCH_MIN_EVENTS_PER_SEC);
+		ret = -ERANGE;
+	}
+
+	return ret;
+}
+
+#ifdef CONFIG_KEYBOARD_SHELL
+static int cmd_bench(const struct shell *sh, size_t argc, char **argv)
+{
+	struct kb_bench_result result;
+	uint32_t iterations = CONFIG_KEYBOARD_BENCH_ITERATIONS;
+	int ret;
+
+	if (argc > 1) {
+		iterations = strtoul(argv[1], NULL, 0);
+	}
+
+	ret = kb_bench_run(iterations, &result);
+	if (ret) {
+		shell_error(sh, "Invalid iteration count");
+		return ret;
+	}
+
+	shell_print(sh, "iterations: %u", result.iterations);
+	shell_print(sh, "press:      %u ns/event", result.press_ns);
+	shell_print(sh, "release:    %u ns/event", result.release_ns);
+	shell_print(sh, "report:     %u ns/report", result.report_ns);
+	shell_print(sh, "event:      %u cycles, %u events/s",
+		    result.event_cyc, result.events_per_sec);
+	shell_print(sh, "queued:     %u ns/event", result.queued_ns);
+	shell_print(sh, "direct:     %u ns/event", result.direct_ns);
+	shell_print(sh, "pipeline:   %u cycles/event", result.pipeline_cyc);
+
+	if (kb_bench_check(&result)) {
+		shell_warn(sh, "Budget exceeded");
+	}
+
+	return 0;
+}
+
+SHELL_SUBCMD_ADD((kb), bench, NULL,
+		 "Run key-state microbenchmarks [iterations]",
+		 cmd_bench, 1, 1);
+#endif /* CONFIG_KEYBOARD_SHELL */
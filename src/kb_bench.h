@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Key-state and report microbenchmarks
+ */
+
+#ifndef KEYBOARD_KB_BENCH_H
+#define KEYBOARD_KB_BENCH_H
+
+#include <stdint.h>
+
+/*
+ * Benchmark results. Timings are in nanoseconds per operation, cycles
+ * are counter cycles of the benchmark clock (host nanoseconds on
+ * native_sim, where simulated time does not advance while code runs).
+ */
+struct kb_bench_result {
+	uint32_t iterations;
+	uint32_t press_ns;
+	uint32_t release_ns;
+	uint32_t report_ns;
+	/* One key event: state update plus report build */
+	uint32_t event_cyc;
+	uint32_t events_per_sec;
+	/* Key event handed to a consumer thread through a message queue */
+	uint32_t queued_ns;
+	/* Key event handled in the caller's context, run to completion */
+	uint32_t direct_ns;
+	/* Key event through the pipeline stages of this build plus report build */
+	uint32_t pipeline_cyc;
+};
+
+/*
+ * Run the key-state microbenchmarks.
+ *
+ * Each iteration presses a rolling set of keys past the 6KRO limit,
+ * builds reports and releases the keys again. The same events are then
+ * handled once through a message queue and a higher priority consumer
+ * thread, like the threaded pipeline, and once directly, like the
+ * run-to-completion engine. Last, they are fed through
+ * kb_pipeline_process() as matrix positions when the build has a
+ * generated keymap, which times the stages this configuration enables.
+ *
+ * @param iterations Number of iterations to run
+ * @param result Filled with the averaged timings
+ * @return 0 on success, -EINVAL if iterations is zero
+ */
+int kb_bench_run(uint32_t iterations, struct kb_bench_result *result);
+
+/*
+ * Check benchmark results against the configured budgets.
+ *
+ * @param result Results of kb_bench_run()
+ * @return 0 if within budget, -ERANGE if a budget is exceeded
+ */
+int kb_bench_check(const struct kb_bench_result *result);
+
+#endif /* KEYBOARD_KB_BENCH_H */
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Host clock for the benchmarks on native_sim
+ *
+ * Built into the native simulator runner, not the embedded image.
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+uint64_t kb_bench_native_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
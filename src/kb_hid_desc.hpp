@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Compile-time HID report descriptor and lookup table builders
+ *
+ * Everything here is constexpr and evaluated by the compiler: the
+ * firmware only contains the resulting bytes. A descriptor built with
+ * Descriptor<> keeps track of the report bits it describes per report
+ * ID and direction, so the report sizes the code relies on can be
+ * checked against the descriptor itself with static_assert. Misuse,
+ * such as a main item without report size and count, an unbalanced
+ * collection or an overflowing buffer, makes valid() false.
+ */
+
+#ifndef KEYBOARD_KB_HID_DESC_HPP
+#define KEYBOARD_KB_HID_DESC_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace kb::hid {
+
+enum Dir : uint8_t {
+	In,
+	Out,
+	Feature,
+	DirCount,
+};
+
+/* Main item data flags */
+constexpr uint8_t kData = 0x00;
+constexpr uint8_t kConst = 0x01;
+constexpr uint8_t kArray = 0x00;
+constexpr uint8_t kVar = 0x02;
+
+constexpr uint8_t kCollectionApplication = 0x01;
+
+/* Report IDs 1 to kMaxReportId, 0 stands for "no report ID" */
+constexpr uint8_t kMaxReportId = 15;
+
+/* Exactly sized copy of a descriptor, see Descriptor::trim() */
+template <size_t N>
+struct Bytes {
+	uint8_t data[N];
+};
+
+template <size_t Capacity>
+class Descriptor {
+public:
+	/* Global items */
+	constexpr Descriptor &usage_page(uint16_t page)
+	{
+		return unsigned_item(0x04, page);
+	}
+
+	constexpr Descriptor &logical_min(int32_t min)
+	{
+		return signed_item(0x14, min);
+	}
+
+	constexpr Descriptor &logical_max(int32_t max)
+	{
+		return signed_item(0x24, max);
+	}
+
+	constexpr Descriptor &report_size(uint8_t bits)
+	{
+		size_ = bits;
+		return unsigned_item(0x74, bits);
+	}
+
+	constexpr Descriptor &report_id(uint8_t id)
+	{
+		if (id == 0 || id > kMaxReportId || bits_[In][0] != 0 ||
+		    bits_[Out][0] != 0 || bits_[Feature][0] != 0) {
+			/* IDs must be used from the first report on */
+			error_ = true;
+		}
+		id_ = id;
+		ids_ = true;
+		return unsigned_item(0x84, id);
+	}
+
+	constexpr Descriptor &report_count(uint16_t count)
+	{
+		count_ = count;
+		return unsigned_item(0x94, count);
+	}
+
+	/* Local items */
+	constexpr Descriptor &usage(uint16_t usage)
+	{
+		return unsigned_item(0x08, usage);
+	}
+
+	constexpr Descriptor &usage_min(uint16_t usage)
+	{
+		return unsigned_item(0x18, usage);
+	}
+
+	constexpr Descriptor &usage_max(uint16_t usage)
+	{
+		return unsigned_item(0x28, usage);
+	}
+
+	/* Main items */
+	constexpr Descriptor &collection(uint8_t type)
+	{
+		depth_++;
+		return unsigned_item(0xa0, type);
+	}
+
+	constexpr Descriptor &end_collection()
+	{
+		if (depth_ == 0) {
+			error_ = true;
+		} else {
+			depth_--;
+		}
+		return byte(0xc0);
+	}
+
+	constexpr Descriptor &input(uint8_t flags)
+	{
+		return field(In, 0x80, flags);
+	}
+
+	constexpr Descriptor &output(uint8_t flags)
+	{
+		return field(Out, 0x90, flags);
+	}
+
+	constexpr Descriptor &feature(uint8_t flags)
+	{
+		return field(Feature, 0xb0, flags);
+	}
+
+	constexpr size_t size() const
+	{
+		return len_;
+	}
+
+	constexpr uint8_t operator[](size_t i) const
+	{
+		return buf_[i];
+	}
+
+	constexpr bool uses_ids() const
+	{
+		return ids_;
+	}
+
+	/* Payload bits of one report, id 0 when no IDs are used */
+	constexpr uint32_t bits(Dir dir, uint8_t id) const
+	{
+		return bits_[dir][id];
+	}
+
+	/* Bytes of one report on the wire, including the ID */
+	constexpr uint32_t report_bytes(Dir dir, uint8_t id) const
+	{
+		return bits_[dir][id] / 8 + (ids_ ? 1 : 0);
+	}
+
+	/* Largest report in one direction */
+	constexpr uint32_t max_report_bytes(Dir dir) const
+	{
+		uint32_t max = 0;
+
+		for (uint8_t id = 0; id <= kMaxReportId; id++) {
+			if (bits_[dir][id] != 0 && report_bytes(dir, id) > max) {
+				max = report_bytes(dir, id);
+			}
+		}
+
+		return max;
+	}
+
+	/* Well formed: no misuse, collections closed, reports byte aligned */
+	constexpr bool valid() const
+	{
+		for (uint8_t d = 0; d < DirCount; d++) {
+			for (uint8_t id = 0; id <= kMaxReportId; id++) {
+				if (bits_[d][id] % 8 != 0) {
+					return false;
+				}
+			}
+		}
+
+		return !error_ && depth_ == 0;
+	}
+
+	/* Copy of the first N bytes, N being size() of the same descriptor */
+	template <size_t N>
+	constexpr Bytes<N> trim() const
+	{
+		Bytes<N> out{};
+
+		for (size_t i = 0; i < N; i++) {
+			out.data[i] = buf_[i];
+		}
+
+		return out;
+	}
+
+private:
+	constexpr Descriptor &byte(uint8_t b)
+	{
+		if (len_ == Capacity) {
+			error_ = true;
+		} else {
+			buf_[len_++] = b;
+		}
+		return *this;
+	}
+
+	/* Short item with the smallest data size holding the value */
+	constexpr Descriptor &unsigned_item(uint8_t prefix, uint32_t v)
+	{
+		if (v <= 0xff) {
+			return byte(prefix | 1).byte(v);
+		}
+		if (v <= 0xffff) {
+			return byte(prefix | 2).byte(v & 0xff).byte(v >> 8);
+		}
+		return byte(prefix | 3).byte(v & 0xff).byte((v >> 8) & 0xff)
+			.byte((v >> 16) & 0xff).byte(v >> 24);
+	}
+
+	/* Logical extents are signed, 255 takes two bytes */
+	constexpr Descriptor &signed_item(uint8_t prefix, int32_t v)
+	{
+		uint32_t u = static_cast<uint32_t>(v);
+
+		if (v >= -128 && v <= 127) {
+			return byte(prefix | 1).byte(u & 0xff);
+		}
+		if (v >= -32768 && v <= 32767) {
+			return byte(prefix | 2).byte(u & 0xff).byte((u >> 8) & 0xff);
+		}
+		return byte(prefix | 3).byte(u & 0xff).byte((u >> 8) & 0xff)
+			.byte((u >> 16) & 0xff).byte(u >> 24);
+	}
+
+	constexpr Descriptor &field(Dir dir, uint8_t prefix, uint8_t flags)
+	{
+		if (size_ == 0 || count_ == 0 || depth_ == 0) {
+			error_ = true;
+		}
+		bits_[dir][id_] += static_cast<uint32_t>(size_) * count_;
+		return unsigned_item(prefix, flags);
+	}
+
+	uint8_t buf_[Capacity]{};
+	size_t len_ = 0;
+	uint32_t bits_[DirCount][kMaxReportId + 1]{};
+	uint16_t count_ = 0;
+	uint8_t size_ = 0;
+	uint8_t id_ = 0;
+	uint8_t depth_ = 0;
+	bool ids_ = false;
+	bool error_ = false;
+};
+
+/* One entry of a sparse code to usage mapping */
+struct KeyMapping {
+	uint16_t code;
+	uint8_t usage;
+};
+
+/* Dense table indexed by code, 0 for codes without a usage */
+template <size_t Size>
+struct KeyTable {
+	uint8_t usage[Size]{};
+	uint8_t max_usage = 0;
+	/* A code mapped twice, to no usage or beyond Size */
+	bool error = false;
+};
+
+template <size_t N>
+constexpr size_t key_table_size(const KeyMapping (&map)[N])
+{
+	size_t size = 0;
+
+	for (const KeyMapping &m : map) {
+		if (m.code >= size) {
+			size = m.code + 1;
+		}
+	}
+
+	return size;
+}
+
+template <size_t Size, size_t N>
+constexpr KeyTable<Size> make_key_table(const KeyMapping (&map)[N])
+{
+	KeyTable<Size> table{};
+
+	for (const KeyMapping &m : map) {
+		if (m.code >= Size || m.usage == 0 || table.usage[m.code] != 0) {
+			table.error = true;
+			continue;
+		}
+
+		table.usage[m.code] = m.usage;
+		if (m.usage > table.max_usage) {
+			table.max_usage = m.usage;
+		}
+	}
+
+	return table;
+}
+
+} /* namespace kb::hid */
+
+#endif /* KEYBOARD_KB_HID_DESC_HPP */
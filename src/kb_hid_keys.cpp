@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * INPUT_KEY to HID keyboard usage lookup
+ */
+
+#include "kb_hid_keys.hpp"
+
+#include "kb_state.h"
+
+using namespace kb::hid;
+
+extern "C" uint8_t kb_input_to_hid(uint16_t input_code)
+{
+	if (input_code < kInputKeysSize) {
+		return kInputKeyTable.usage[input_code];
+	}
+	return 0;
+}
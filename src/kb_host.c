@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Host type detection from enumeration behavior
+ *
+ * The HID class answers descriptor requests itself, so the fingerprint
+ * is built from what the application does see: bus resets, the
+ * configuration, Set Protocol, Set Idle and report requests, and their
+ * timing. Some time after the configuration the host is classified:
+ *
+ *   Set Protocol (boot)                  BIOS
+ *   Set Protocol (boot), extra resets    KVM
+ *   no Set Protocol, Set Idle            OS
+ *   nothing                              BIOS that assumes boot layout
+ *
+ * Most hosts reset twice while enumerating, KVM switches that re-enumerate
+ * on every port switch add more.
+ */
+
+#include "kb_host.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/usb/class/hid.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(kb_host, CONFIG_KEYBOARD_LOG_LEVEL);
+
+/* More bus resets than this before the configuration suggest a KVM */
+#define HOST_KVM_RESETS 2
+
+/* HID 1.11 recommends 500 ms as the default idle rate of keyboards */
+#define HOST_BOOT_IDLE_MS 500
+
+static const struct kb_host_profile host_profiles[] = {
+	[KB_HOST_UNKNOWN] = { 0 },
+	[KB_HOST_OS] = { 0 },
+	[KB_HOST_BIOS] = {
+		.idle_ms = HOST_BOOT_IDLE_MS,
+	},
+	[KB_HOST_KVM] = {
+		.idle_ms = HOST_BOOT_IDLE_MS,
+	},
+};
+
+static struct k_spinlock host_lock;
+static struct kb_host_fingerprint host_fp = {
+	.protocol = UINT8_MAX,
+};
+static enum kb_host_type host_type;
+static int64_t host_reset_at;
+static int64_t host_config_at;
+static bool host_configured;
+static kb_host_cb_t host_cb;
+
+static enum kb_host_type host_classify(const struct kb_host_fingerprint *fp)
+{
+	if (fp->protocol == HID_PROTOCOL_BOOT) {
+		return fp->resets > HOST_KVM_RESETS ? KB_HOST_KVM : KB_HOST_BIOS;
+	}
+
+	if (fp->idle_set) {
+		return KB_HOST_OS;
+	}
+
+	if (fp->protocol == UINT8_MAX && fp->reports == 0) {
+		/* Never talked HID to us, parses the report as boot layout */
+		return KB_HOST_BIOS;
+	}
+
+	return KB_HOST_UNKNOWN;
+}
+
+static void host_settle_handler(struct k_work *work)
+{
+	struct kb_host_profile profile;
+	struct kb_host_fingerprint fp;
+	enum kb_host_type type;
+	k_spinlock_key_t key;
+
+	ARG_UNUSED(work);
+
+	key = k_spin_lock(&host_lock);
+	fp = host_fp;
+	type = host_classify(&fp);
+	host_type = type;
+	k_spin_unlock(&host_lock, key);
+
+	profile = host_profiles[type];
+	if (fp.idle_set) {
+		/* The host asked for an idle period, never override it */
+		profile.idle_ms = 0;
+	}
+
+	LOG_INF("Host %s: resets %u, protocol %d, idle %s, reports %u, config %u ms",
+		kb_host_type_str(type), fp.resets,
+		fp.protocol == UINT8_MAX ? -1 : fp.protocol,
+		fp.idle_set ? "set" : "unset", fp.reports, fp.config_ms);
+
+	if (host_cb != NULL) {
+		host_cb(type, &profile);
+	}
+}
+
+static K_WORK_DELAYABLE_DEFINE(host_settle_work, host_settle_handler);
+
+void kb_host_init(kb_host_cb_t cb)
+{
+	host_cb = cb;
+}
+
+void kb_host_on_msg(enum usbd_msg_type type)
+{
+	k_spinlock_key_t key = k_spin_lock(&host_lock);
+	int64_t now = k_uptime_get();
+	bool forget = false;
+
+	switch (type) {
+	case USBD_MSG_RESET:
+		if (host_configured || host_fp.resets == 0) {
+			forget = host_type != KB_HOST_UNKNOWN;
+			/* New enumeration, keep counting resets until configured */
+			host_fp = (struct kb_host_fingerprint){
+				.protocol = UINT8_MAX,
+			};
+			host_reset_at = now;
+			host_configured = false;
+			host_type = KB_HOST_UNKNOWN;
+		}
+
+		host_fp.resets++;
+		k_spin_unlock(&host_lock, key);
+		k_work_cancel_delayable(&host_settle_work);
+
+		/* A KVM may have switched to another host, drop the old profile */
+		if (forget && host_cb != NULL) {
+			host_cb(KB_HOST_UNKNOWN, &host_profiles[KB_HOST_UNKNOWN]);
+		}
+		return;
+	case USBD_MSG_CONFIGURATION:
+		host_configured = true;
+		host_config_at = now;
+		host_fp.config_ms = (uint32_t)(now - host_reset_at);
+		k_spin_unlock(&host_lock, key);
+		k_work_reschedule(&host_settle_work, K_MSEC(CONFIG_KEYBOARD_HOST_DETECT_MS));
+		return;
+	default:
+		break;
+	}
+
+	k_spin_unlock(&host_lock, key);
+}
+
+void kb_host_on_protocol(uint8_t protocol)
+{
+	k_spinlock_key_t key = k_spin_lock(&host_lock);
+
+	host_fp.protocol = protocol;
+	k_spin_unlock(&host_lock, key);
+}
+
+void kb_host_on_idle(uint32_t duration)
+{
+	k_spinlock_key_t key = k_spin_lock(&host_lock);
+
+	if (!host_fp.idle_set) {
+		host_fp.idle_delay_ms = (uint32_t)(k_uptime_get() - host_config_at);
+	}
+
+	host_fp.idle_set = true;
+	host_fp.idle_ms = duration;
+	k_spin_unlock(&host_lock, key);
+}
+
+void kb_host_on_report(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&host_lock);
+
+	if (host_fp.reports < UINT8_MAX) {
+		host_fp.reports++;
+	}
+
+	k_spin_unlock(&host_lock, key);
+}
+
+enum kb_host_type kb_host_type_get(struct kb_host_fingerprint *fp)
+{
+	k_spinlock_key_t key = k_spin_lock(&host_lock);
+	enum kb_host_type type = host_type;
+
+	if (fp != NULL) {
+		*fp = host_fp;
+	}
+
+	k_spin_unlock(&host_lock, key);
+
+	return type;
+}
+
+const char *kb_host_type_str(enum kb_host_type type)
+{
+	switch (type) {
+	case KB_HOST_OS:
+		return "os";
+	case KB_HOST_BIOS:
+		return "bios";
+	case KB_HOST_KVM:
+		return "kvm";
+	default:
+		return "unknown";
+	}
+}
+
+#ifdef CONFIG_KEYBOARD_SHELL
+static int cmd_host(const struct shell *sh, size_t argc, char **argv)
+{
+	struct kb_host_fingerprint fp;
+	enum kb_host_type type = kb_host_type_get(&fp);
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	shell_print(sh, "host:       %s", kb_host_type_str(type));
+	shell_print(sh, "resets:     %u", fp.resets);
+	shell_print(sh, "protocol:   %s", fp.protocol == UINT8_MAX ? "not set" :
+		    fp.protocol == HID_PROTOCOL_BOOT ? "boot" : "report");
+	if (fp.idle_set) {
+		shell_print(sh, "idle:       %u ms, set %u ms after config",
+			    fp.idle_ms, fp.idle_delay_ms);
+	} else {
+		shell_print(sh, "idle:       not set");
+	}
+	shell_print(sh, "reports:    %u", fp.reports);
+	shell_print(sh, "configured: %u ms after reset", fp.config_ms);
+
+	return 0;
+}
+
+SHELL_SUBCMD_ADD((kb), host, NULL,
+		 "Show the detected host type and its fingerprint",
+		 cmd_host, 1, 0);
+#endif /* CONFIG_KEYBOARD_SHELL */
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Host type detection from enumeration behavior
+ */
+
+#ifndef KEYBOARD_KB_HOST_H
+#define KEYBOARD_KB_HOST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/usb/usbd_msg.h>
+
+enum kb_host_type {
+	/* Not classified yet, or no rule matched */
+	KB_HOST_UNKNOWN,
+	/* Full HID driver: report protocol, sets idle */
+	KB_HOST_OS,
+	/* Firmware boot keyboard driver */
+	KB_HOST_BIOS,
+	/* Boot keyboard driver behind repeated bus resets */
+	KB_HOST_KVM,
+};
+
+/*
+ * Behavior selected for the detected host. The report layout is not
+ * part of it, the protocol the host selected alone decides that.
+ */
+struct kb_host_profile {
+	/* Idle period to apply when the host never set one, 0 for none */
+	uint32_t idle_ms;
+};
+
+/* What the host did since the last bus reset */
+struct kb_host_fingerprint {
+	uint8_t resets;
+	/* HID_PROTOCOL_* set by the host, UINT8_MAX if never set */
+	uint8_t protocol;
+	bool idle_set;
+	uint32_t idle_ms;
+	uint8_t reports;
+	/* Milliseconds from the first reset to the configuration */
+	uint32_t config_ms;
+	/* Milliseconds from the configuration to the first Set Idle */
+	uint32_t idle_delay_ms;
+};
+
+/*
+ * Called with the classification once enumeration settled, and with
+ * KB_HOST_UNKNOWN when a bus reset discards it.
+ */
+typedef void (*kb_host_cb_t)(enum kb_host_type type,
+			     const struct kb_host_profile *profile);
+
+/*
+ * Set the callback applying the selected profile.
+ *
+ * @param cb Called from the system work queue or the USB stack thread
+ */
+void kb_host_init(kb_host_cb_t cb);
+
+/* Feed USB device messages, from msg_cb() */
+void kb_host_on_msg(enum usbd_msg_type type);
+
+/* Feed HID class requests, from the HID device callbacks */
+void kb_host_on_protocol(uint8_t protocol);
+void kb_host_on_idle(uint32_t duration);
+void kb_host_on_report(void);
+
+/*
+ * Get the current classification.
+ *
+ * @param fp If not NULL, set to the fingerprint it is based on
+ * @return Host type
+ */
+enum kb_host_type kb_host_type_get(struct kb_host_fingerprint *fp);
+
+/* Printable host type name */
+const char *kb_host_type_str(enum kb_host_type type);
+
+#endif /* KEYBOARD_KB_HOST_H */
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Synthetic input device for high-rate stress generation
+ *
+ * Generates key events far faster than human typing and reports them
+ * through the input subsystem, so they reach input_cb() exactly like
+ * matrix events. Workloads are driven by a seeded PRNG and therefore
+ * reproducible.
+ */
+
+#include "kb_state.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/input/input.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(kb_input_emul, CONFIG_KEYBOARD_LOG_LEVEL);
+
+/* Highest input code looked at when collecting the mapped keys */
+#define EMUL_MAX_CODE 256
+/* Keys held down at once by the rolling chord workload */
+#define EMUL_CHORD_SIZE 3
+
+enum emul_workload {
+	EMUL_MASH,
+	EMUL_SWEEP,
+	EMUL_CHORDS,
+};
+
+static const char *const workload_names[] = {
+	[EMUL_MASH] = "mash",
+	[EMUL_SWEEP] = "sweep",
+	[EMUL_CHORDS] = "chords",
+};
+
+struct emul_data {
+	uint16_t keys[EMUL_MAX_CODE];
+	uint16_t key_count;
+	enum emul_workload workload;
+	uint32_t per_ms;
+	uint32_t remaining;
+	uint32_t rng;
+	uint32_t step;
+	uint32_t emitted;
+	uint32_t late_ms;
+	bool running;
+	struct k_sem start;
+	ATOMIC_DEFINE(pressed, EMUL_MAX_CODE);
+};
+
+static struct emul_data emul_data;
+
+/* xorshift32, small and deterministic for a given seed */
+static uint32_t emul_rand(struct emul_data *data)
+{
+	uint32_t x = data->rng;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	data->rng = x;
+
+	return x;
+}
+
+static void emul_report(const struct device *dev, uint16_t idx, bool pressed)
+{
+	struct emul_data *data = dev->data;
+
+	atomic_set_bit_to(data->pressed, idx, pressed);
+	input_report_key(dev, data->keys[idx], pressed, true, K_FOREVER);
+	data->emitted++;
+}
+
+static bool emul_is_pressed(const struct device *dev, uint16_t idx)
+{
+	struct emul_data *data = dev->data;
+
+	return atomic_test_bit(data->pressed, idx);
+}
+
+/* Generate the next event of the selected workload */
+static void emul_next(const struct device *dev)
+{
+	struct emul_data *data = dev->data;
+	uint32_t n = data->step++;
+	uint16_t idx;
+
+	switch (data->workload) {
+	case EMUL_MASH:
+		idx = emul_rand(data) % data->key_count;
+		emul_report(dev, idx, !emul_is_pressed(dev, idx));
+		break;
+	case EMUL_SWEEP:
+		/* Press every mapped key code in order, then release them in order */
+		idx = n % data->key_count;
+		emul_report(dev, idx, (n / data->key_count) % 2 == 0);
+		break;
+	case EMUL_CHORDS:
+		if (n < EMUL_CHORD_SIZE) {
+			/* Build up the first chord */
+			emul_report(dev, n % data->key_count, true);
+			break;
+		}
+
+		/* Then roll: release the oldest key, press the one after the newest */
+		n -= EMUL_CHORD_SIZE;
+		idx = (n / 2) % data->key_count;
+		if (n % 2 == 0) {
+			emul_report(dev, idx, false);
+		} else {
+			emul_report(dev, (idx + EMUL_CHORD_SIZE) % data->key_count, true);
+		}
+		break;
+	}
+}
+
+static void emul_release_all(const struct device *dev)
+{
+	struct emul_data *data = dev->data;
+
+	for (uint16_t i = 0; i < data->key_count; i++) {
+		if (emul_is_pressed(dev, i)) {
+			emul_report(dev, i, false);
+		}
+	}
+}
+
+static void emul_thread(void *p1, void *p2, void *p3)
+{
+	const struct device *dev = p1;
+	struct emul_data *data = dev->data;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		k_timepoint_t next;
+
+		k_sem_take(&data->start, K_FOREVER);
+		next = sys_timepoint_calc(K_MSEC(1));
+
+		while (data->running) {
+			for (uint32_t i = 0; i < data->per_ms && data->remaining; i++) {
+				emul_next(dev);
+				data->remaining--;
+			}
+
+			if (data->remaining == 0U) {
+				data->running = false;
+				break;
+			}
+
+			if (sys_timepoint_expired(next)) {
+				data->late_ms++;
+			} else {
+				k_sleep(sys_timepoint_timeout(next));
+			}
+			next = sys_timepoint_calc(K_MSEC(1));
+		}
+
+		emul_release_all(dev);
+		LOG_INF("%s done, %u events, %u ms late",
+			workload_names[data->workload], data->emitted, data->late_ms);
+	}
+}
+
+K_THREAD_STACK_DEFINE(emul_stack, CONFIG_KEYBOARD_INPUT_EMUL_STACK_SIZE);
+static struct k_thread emul_thread_data;
+
+static int emul_init(const struct device *dev)
+{
+	struct emul_data *data = dev->data;
+
+	/* Emulate every key the report builder knows about */
+	for (uint16_t code = 0; code < EMUL_MAX_CODE; code++) {
+		if (kb_input_to_hid(code) != 0 || kb_modifier_bit(code) != 0) {
+			data->keys[data->key_count++] = code;
+		}
+	}
+
+	k_sem_init(&data->start, 0, 1);
+	k_thread_create(&emul_thread_data, emul_stack,
+			K_THREAD_STACK_SIZEOF(emul_stack), emul_thread,
+			(void *)dev, NULL, NULL,
+			CONFIG_KEYBOARD_INPUT_EMUL_PRIORITY, 0, K_NO_WAIT);
+	k_thread_name_set(&emul_thread_data, "kb_input_emul");
+
+	return 0;
+}
+
+DEVICE_DEFINE(kb_input_emul, "kb_input_emul", emul_init, NULL,
+	      &emul_data, NULL, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY,
+	      NULL);
+
+static int cmd_emul_start(const struct shell *sh, size_t argc, char **argv)
+{
+	const struct device *dev = DEVICE_GET(kb_input_emul);
+	struct emul_data *data = dev->data;
+	int workload = -1;
+
+	if (data->running) {
+		shell_error(sh, "Already running");
+		return -EBUSY;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(workload_names); i++) {
+		if (strcmp(argv[1], workload_names[i]) == 0) {
+			workload = i;
+		}
+	}
+
+	if (workload < 0) {
+		shell_error(sh, "Unknown workload %s", argv[1]);
+		return -EINVAL;
+	}
+
+	data->workload = workload;
+	data->per_ms = argc > 2 ? strtoul(argv[2], NULL, 0) : 1;
+	data->remaining = argc > 3 ? strtoul(argv[3], NULL, 0) : 1000;
+	data->rng = argc > 4 ? strtoul(argv[4], NULL, 0) : CONFIG_KEYBOARD_INPUT_EMUL_SEED;
+	if (data->per_ms == 0U || data->remaining == 0U || data->rng == 0U) {
+		shell_error(sh, "Rate, count and seed must be non-zero");
+		return -EINVAL;
+	}
+
+	data->step = 0;
+	data->emitted = 0;
+	data->late_ms = 0;
+	data->running = true;
+	k_sem_give(&data->start);
+
+	return 0;
+}
+
+static int cmd_emul_stop(const struct shell *sh, size_t argc, char **argv)
+{
+	const struct device *dev = DEVICE_GET(kb_input_emul);
+	struct emul_data *data = dev->data;
+
+	data->running = false;
+
+	return 0;
+}
+
+static int cmd_emul_stats(const struct shell *sh, size_t argc, char **argv)
+{
+	const struct device *dev = DEVICE_GET(kb_input_emul);
+	struct emul_data *data = dev->data;
+
+	shell_print(sh, "workload: %s (%s)", workload_names[data->workload],
+		    data->running ? "running" : "stopped");
+	shell_print(sh, "keys:     %u", data->key_count);
+	shell_print(sh, "events:   %u", data->emitted);
+	shell_print(sh, "late:     %u ms", data->late_ms);
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_emul,
+	SHELL_CMD_ARG(start, NULL,
+		      "<mash|sweep|chords> [events/ms] [count] [seed]",
+		      cmd_emul_start, 2, 3),
+	SHELL_CMD(stop, NULL, "Stop the running workload", cmd_emul_stop),
+	SHELL_CMD(stats, NULL, "Show generator statistics", cmd_emul_stats),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_SUBCMD_ADD((kb), emul, &sub_emul, "Synthetic input device", NULL, 1, 0);
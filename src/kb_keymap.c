@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Keymap compiled from the layout file by tools/keymap_compiler
+ *
+ * The matrix reports raw positions, so an action lookup is one indexed
+ * load from the active layer instead of the INPUT_KEY to HID
+ * translation done for keymap-less sources.
+ *
+ * After a leader key, presses of regular keys walk the leader trie
+ * instead of reaching the host, one node per key. The key completing a
+ * sequence holds the sequence's action until it is released. Modifiers
+ * and layer keys act normally within a sequence.
+ *
+ * The compiler lists the action types the layout can resolve to in
+ * KB_KEYMAP_ACTION_TYPES. Stages for other types are constant-folded
+ * away: a single-layer, keys-only layout costs one table load and the
+ * key state update per event, with no layer walk, leader check or
+ * action type dispatch. The leader tables only exist in layouts with
+ * sequences.
+ */
+
+#include "kb_keymap.h"
+#include "kb_macro.h"
+#include "kb_scan_history.h"
+#include "kb_stamp.h"
+
+#include <errno.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+
+#include "kb_keymap_generated.h"
+
+BUILD_ASSERT(KB_KEYMAP_LAYERS <= 16, "layer mask is 16 bits");
+
+/* The layout has actions of this type */
+#define KEYMAP_HAS(type) ((KB_KEYMAP_ACTION_TYPES & BIT(type)) != 0)
+/* The action is of this type, without a check when it is the only one */
+#define KEYMAP_IS(action, type)						\
+	(KEYMAP_HAS(type) &&						\
+	 (KB_KEYMAP_ACTION_TYPES == BIT(type) || KB_ACTION_TYPE(action) == (type)))
+
+/* Base layer is always active */
+static uint16_t layer_mask = BIT(0);
+/* Action resolved at press time, so releases match across layer changes */
+static uint16_t held_actions[KB_KEYMAP_KEYS];
+static uint16_t matrix_row;
+static uint16_t matrix_col;
+
+#if KB_KEYMAP_LEADER_COUNT > 0
+/* Trie node of the leader sequence typed so far */
+#define LEADER_IDLE UINT16_MAX
+static uint16_t leader_node = LEADER_IDLE;
+static uint32_t leader_at;
+#endif
+
+bool kb_keymap_input(const struct input_event *evt, uint16_t *pos, bool *pressed)
+{
+	if (evt->type == INPUT_EV_ABS) {
+		if (evt->code == INPUT_ABS_X) {
+			matrix_col = evt->value;
+		} else if (evt->code == INPUT_ABS_Y) {
+			matrix_row = evt->value;
+		}
+		return false;
+	}
+
+	if (evt->type != INPUT_EV_KEY || evt->code != INPUT_BTN_TOUCH) {
+		return false;
+	}
+
+	if (matrix_row >= KB_KEYMAP_ROWS || matrix_col >= KB_KEYMAP_COLS) {
+		return false;
+	}
+
+	*pos = matrix_row * KB_KEYMAP_COLS + matrix_col;
+	*pressed = evt->value != 0;
+
+	return true;
+}
+
+uint16_t kb_keymap_resolve(uint16_t pos)
+{
+	uint32_t mask = layer_mask;
+	uint16_t action;
+
+	if (KB_KEYMAP_LAYERS == 1 || !KEYMAP_HAS(KB_ACTION_LAYER)) {
+		/* Nothing switches layers, transparent positions stay unmapped */
+		action = kb_keymap_layers[0][pos];
+		return action != KB_ACTION_TRANS ? action : KB_ACTION_NONE;
+	}
+
+	while (mask != 0U) {
+		uint32_t layer = find_msb_set(mask) - 1;
+
+		action = kb_keymap_layers[layer][pos];
+
+		if (action != KB_ACTION_TRANS) {
+			return action;
+		}
+		mask &= ~BIT(layer);
+	}
+
+	return KB_ACTION_NONE;
+}
+
+#if KB_KEYMAP_LEADER_COUNT > 0
+/*
+ * Advance the leader sequence with the action of a pressed key. Returns
+ * the action the key takes: its own outside a sequence, the sequence's
+ * once complete, KB_ACTION_NONE while typing it or on a mismatch.
+ * The timeout counts from the detection of the leader to that of the key.
+ */
+static uint16_t leader_advance(uint16_t action, uint32_t now)
+{
+	uint16_t usage = KB_ACTION_PARAM(action);
+	uint16_t next;
+	uint8_t code;
+
+	if ((int32_t)(now - leader_at) > KB_KEYMAP_LEADER_TIMEOUT_MS) {
+		leader_node = LEADER_IDLE;
+		return action;
+	}
+
+	if (KB_ACTION_TYPE(action) != KB_ACTION_KEY || action == KB_ACTION_NONE ||
+	    usage >= KB_KEYMAP_LEADER_CODES) {
+		return action;
+	}
+
+	code = kb_keymap_leader_codes[usage];
+	next = kb_keymap_leader_trie[leader_node].base + code;
+	if (code == 0 || next >= KB_KEYMAP_LEADER_NODES ||
+	    kb_keymap_leader_trie[next].check != leader_node) {
+		/* Not a sequence, the keys typed after the leader are dropped */
+		leader_node = LEADER_IDLE;
+		return KB_ACTION_NONE;
+	}
+
+	action = kb_keymap_leader_trie[next].action;
+	leader_node = action != KB_ACTION_NONE ? LEADER_IDLE : next;
+
+	return action;
+}
+#endif /* KB_KEYMAP_LEADER_COUNT > 0 */
+
+int kb_keymap_process(struct kb_state *state, uint16_t pos, bool pressed, uint32_t stamp)
+{
+	uint16_t action;
+
+	if (pos >= KB_KEYMAP_KEYS) {
+		return -EINVAL;
+	}
+
+	if (pressed) {
+		action = kb_keymap_resolve(pos);
+#if KB_KEYMAP_LEADER_COUNT > 0
+		if (KEYMAP_HAS(KB_ACTION_LEADER) && leader_node != LEADER_IDLE) {
+			action = leader_advance(action, kb_stamp_uptime_ms(stamp));
+		}
+#endif
+		held_actions[pos] = action;
+	} else {
+		action = held_actions[pos];
+		held_actions[pos] = KB_ACTION_NONE;
+	}
+
+	/* Most frequent first, absent types are folded away */
+	if (KEYMAP_IS(action, KB_ACTION_KEY)) {
+		if (action == KB_ACTION_NONE) {
+			return -ENOENT;
+		}
+		return kb_state_process_hid(state, KB_ACTION_PARAM(action), pressed);
+	}
+
+	if (KEYMAP_IS(action, KB_ACTION_LAYER)) {
+		WRITE_BIT(layer_mask, KB_ACTION_PARAM(action), pressed);
+		return 0;
+	}
+
+#if KB_KEYMAP_LEADER_COUNT > 0
+	if (KEYMAP_IS(action, KB_ACTION_LEADER)) {
+		if (pressed) {
+			leader_node = 0;
+			leader_at = kb_stamp_uptime_ms(stamp);
+		}
+		return 0;
+	}
+#endif
+
+	if (IS_ENABLED(CONFIG_KEYBOARD_DYNAMIC_MACRO) &&
+	    KEYMAP_IS(action, KB_ACTION_DYN_MACRO)) {
+		if (!pressed) {
+			return 0;
+		}
+		return KB_ACTION_PARAM(action) == KB_DYN_MACRO_RECORD ?
+		       kb_macro_record_toggle() : kb_macro_play();
+	}
+
+	if (IS_ENABLED(CONFIG_KEYBOARD_SCAN_HISTORY) &&
+	    KEYMAP_IS(action, KB_ACTION_SCAN_FREEZE)) {
+		if (pressed) {
+			kb_scan_history_freeze(KB_SCAN_FROZEN_USER);
+		}
+		return 0;
+	}
+
+	return -ENOTSUP;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Keymap compiled from the layout file by tools/keymap_compiler
+ */
+
+#ifndef KEYBOARD_KB_KEYMAP_H
+#define KEYBOARD_KB_KEYMAP_H
+
+#include "kb_state.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/input/input.h>
+
+/*
+ * Packed 16-bit actions: bits 15..12 hold the action type and bits
+ * 11..0 its parameter (HID usage, layer or dynamic macro operation).
+ */
+#define KB_ACTION_TYPE(action) ((action) >> 12)
+#define KB_ACTION_PARAM(action) ((action) & 0x0fff)
+#define KB_ACTION(type, param) (((type) << 12) | ((param) & 0x0fff))
+
+/* No action, also used for matrix positions without a switch */
+#define KB_ACTION_NONE 0x0000
+/* Fall through to the next active layer below */
+#define KB_ACTION_TRANS 0x0001
+
+enum kb_action_type {
+	KB_ACTION_KEY = 0,
+	KB_ACTION_LAYER,
+	/* 2 and 3 are kept for tap-hold keys and macros */
+	/* Start a leader sequence */
+	KB_ACTION_LEADER = 4,
+	/* Dynamic macro, parameter KB_DYN_MACRO_* */
+	KB_ACTION_DYN_MACRO,
+	/* Freeze the raw scan history */
+	KB_ACTION_SCAN_FREEZE,
+};
+
+#define KB_DYN_MACRO_RECORD 0
+#define KB_DYN_MACRO_PLAY 1
+
+/*
+ * Node of the leader sequence trie, a double array: the child for code c
+ * is at base + c if its check is this node's index.
+ */
+struct kb_keymap_leader_node {
+	uint16_t base;
+	uint16_t check;
+	/* Action of a complete sequence, KB_ACTION_NONE for inner nodes */
+	uint16_t action;
+};
+
+/*
+ * Collect raw matrix events (column, row, touch) from the input subsystem.
+ *
+ * @param evt Input event
+ * @param pos Set to the matrix position when a key event completes
+ * @param pressed Set to the key state when a key event completes
+ * @return true when a key event completed, false otherwise
+ */
+bool kb_keymap_input(const struct input_event *evt, uint16_t *pos, bool *pressed);
+
+/*
+ * Look up the action of a matrix position in the active layers.
+ *
+ * @param pos Matrix position, row * columns + column
+ * @return Packed action, KB_ACTION_NONE if nothing is mapped
+ */
+uint16_t kb_keymap_resolve(uint16_t pos);
+
+/*
+ * Apply a matrix key event to the key state.
+ *
+ * @param state Key state to update
+ * @param pos Matrix position, row * columns + column
+ * @param pressed True on press, false on release
+ * @param stamp Detection stamp of the event, see kb_stamp.h
+ * @return 0 on success, -EINVAL for an invalid position, -ENOENT if
+ *         nothing is mapped, -ENOSPC if the 6KRO limit is reached,
+ *         -ENOTSUP for actions this build does not handle
+ */
+int kb_keymap_process(struct kb_state *state, uint16_t pos, bool pressed, uint32_t stamp);
+
+#endif /* KEYBOARD_KB_KEYMAP_H */
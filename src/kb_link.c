@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * USB connection state and recovery after resets
+ *
+ * A bus reset, a reconfiguration or a KVM port switch makes the host
+ * forget the keyboard: pressed keys, protocol and idle rate. The link
+ * follows the USB device state from the stack messages and the HID
+ * interface state, and tells the application when to drop its
+ * per-enumeration settings and when to resend the current key state,
+ * without waiting for the next key event:
+ *
+ *   DETACHED -VBUS-> POWERED -reset-> DEFAULT -config-> CONFIGURED
+ *   CONFIGURED -iface ready-> READY -suspend-> SUSPENDED -resume-> READY
+ *
+ * The recovery time runs from the bus reset to the first completed IN
+ * transfer after the interface became ready.
+ */
+
+#include "kb_link.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(kb_link, CONFIG_KEYBOARD_LOG_LEVEL);
+
+static struct k_spinlock link_lock;
+static struct kb_link_stats link_stats;
+/* State to return to on resume */
+static enum kb_link_state link_resume_state;
+static int64_t link_reset_at;
+static bool link_recovering;
+static kb_link_cb_t link_cb;
+
+void kb_link_init(kb_link_cb_t cb)
+{
+	link_cb = cb;
+}
+
+/* Enter a state, return the state to report to the application */
+static enum kb_link_state link_enter(enum kb_link_state state)
+{
+	enum kb_link_state notify = KB_LINK_DETACHED;
+
+	if (state == KB_LINK_DEFAULT) {
+		link_stats.resets++;
+		link_reset_at = k_uptime_ticks();
+		link_recovering = true;
+		notify = KB_LINK_DEFAULT;
+	} else if (state == KB_LINK_READY) {
+		link_stats.resyncs++;
+		notify = KB_LINK_READY;
+	}
+
+	link_stats.state = state;
+
+	return notify;
+}
+
+void kb_link_on_msg(enum usbd_msg_type type)
+{
+	k_spinlock_key_t key = k_spin_lock(&link_lock);
+	enum kb_link_state notify = KB_LINK_DETACHED;
+
+	switch (type) {
+	case USBD_MSG_VBUS_READY:
+		link_stats.vbus_events++;
+		notify = link_enter(KB_LINK_POWERED);
+		break;
+	case USBD_MSG_VBUS_REMOVED:
+		link_stats.vbus_events++;
+		link_recovering = false;
+		notify = link_enter(KB_LINK_DETACHED);
+		break;
+	case USBD_MSG_RESET:
+		notify = link_enter(KB_LINK_DEFAULT);
+		break;
+	case USBD_MSG_CONFIGURATION:
+		link_stats.configurations++;
+		if (link_stats.state != KB_LINK_READY) {
+			notify = link_enter(KB_LINK_CONFIGURED);
+		}
+		break;
+	case USBD_MSG_SUSPEND:
+		if (link_stats.state != KB_LINK_SUSPENDED) {
+			link_stats.suspends++;
+			link_resume_state = link_stats.state;
+			notify = link_enter(KB_LINK_SUSPENDED);
+		}
+		break;
+	case USBD_MSG_RESUME:
+		if (link_stats.state != KB_LINK_SUSPENDED) {
+			break;
+		}
+
+		if (link_resume_state == KB_LINK_READY) {
+			/* Keys may have changed while the bus was asleep */
+			notify = link_enter(KB_LINK_READY);
+		} else {
+			link_stats.state = link_resume_state;
+		}
+		break;
+	default:
+		break;
+	}
+
+	k_spin_unlock(&link_lock, key);
+
+	if (notify != KB_LINK_DETACHED && link_cb != NULL) {
+		link_cb(notify);
+	}
+}
+
+void kb_link_on_ready(bool ready)
+{
+	k_spinlock_key_t key = k_spin_lock(&link_lock);
+	enum kb_link_state notify = KB_LINK_DETACHED;
+
+	if (ready) {
+		notify = link_enter(KB_LINK_READY);
+	} else if (link_stats.state == KB_LINK_READY) {
+		notify = link_enter(KB_LINK_CONFIGURED);
+	}
+
+	k_spin_unlock(&link_lock, key);
+
+	if (notify != KB_LINK_DETACHED && link_cb != NULL) {
+		link_cb(notify);
+	}
+}
+
+void kb_link_report_done(void)
+{
+	k_spinlock_key_t key;
+	uint32_t us;
+
+	if (!link_recovering) {
+		return;
+	}
+
+	key = k_spin_lock(&link_lock);
+	if (link_recovering && link_stats.state == KB_LINK_READY) {
+		us = (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks() - link_reset_at);
+		link_stats.recovery_us = us;
+		link_stats.recovery_max_us = MAX(link_stats.recovery_max_us, us);
+		link_recovering = false;
+	}
+	k_spin_unlock(&link_lock, key);
+}
+
+void kb_link_get(struct kb_link_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&link_lock);
+
+	*stats = link_stats;
+	k_spin_unlock(&link_lock, key);
+}
+
+const char *kb_link_state_str(enum kb_link_state state)
+{
+	switch (state) {
+	case KB_LINK_DETACHED:
+		return "detached";
+	case KB_LINK_POWERED:
+		return "powered";
+	case KB_LINK_DEFAULT:
+		return "default";
+	case KB_LINK_CONFIGURED:
+		return "configured";
+	case KB_LINK_READY:
+		return "ready";
+	case KB_LINK_SUSPENDED:
+		return "suspended";
+	default:
+		return "unknown";
+	}
+}
+
+#ifdef CONFIG_KEYBOARD_SHELL
+static int cmd_usb_link(const struct shell *sh, size_t argc, char **argv)
+{
+	struct kb_link_stats stats;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	kb_link_get(&stats);
+
+	shell_print(sh, "state:          %s", kb_link_state_str(stats.state));
+	shell_print(sh, "resets:         %u", stats.resets);
+	shell_print(sh, "configurations: %u", stats.configurations);
+	shell_print(sh, "vbus events:    %u", stats.vbus_events);
+	shell_print(sh, "suspends:       %u", stats.suspends);
+	shell_print(sh, "resyncs:        %u", stats.resyncs);
+	shell_print(sh, "recovery:       %u us, max %u us",
+		    stats.recovery_us, stats.recovery_max_us);
+
+	return 0;
+}
+
+SHELL_SUBCMD_ADD((kb, usb), link, NULL,
+		 "Show the connection state and reset recovery time",
+		 cmd_usb_link, 1, 0);
+#endif /* CONFIG_KEYBOARD_SHELL */
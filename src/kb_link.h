@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * USB connection state and recovery after resets
+ */
+
+#ifndef KEYBOARD_KB_LINK_H
+#define KEYBOARD_KB_LINK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/usb/usbd_msg.h>
+
+enum kb_link_state {
+	/* No VBUS, or the device stack is disabled */
+	KB_LINK_DETACHED,
+	/* VBUS present, waiting for a bus reset */
+	KB_LINK_POWERED,
+	/* Bus reset seen, not configured yet */
+	KB_LINK_DEFAULT,
+	/* Configured, the HID interface is not enabled yet */
+	KB_LINK_CONFIGURED,
+	/* The HID interface is enabled, reports reach the host */
+	KB_LINK_READY,
+	KB_LINK_SUSPENDED,
+};
+
+struct kb_link_stats {
+	enum kb_link_state state;
+	uint32_t resets;
+	uint32_t configurations;
+	uint32_t vbus_events;
+	uint32_t suspends;
+	/* Times the current key state was resent to the host */
+	uint32_t resyncs;
+	/* Microseconds from the bus reset to the first completed report */
+	uint32_t recovery_us;
+	uint32_t recovery_max_us;
+};
+
+/*
+ * Called on the transitions the application acts on: KB_LINK_DEFAULT
+ * after a bus reset, when the host forgot the protocol and idle
+ * settings, and KB_LINK_READY when the interface became ready or the
+ * bus resumed, when the host needs the current key state.
+ */
+typedef void (*kb_link_cb_t)(enum kb_link_state state);
+
+/*
+ * Set the callback acting on state transitions.
+ *
+ * @param cb Called from the USB stack thread
+ */
+void kb_link_init(kb_link_cb_t cb);
+
+/* Feed USB device messages, from msg_cb() */
+void kb_link_on_msg(enum usbd_msg_type type);
+
+/* Feed the HID interface state, from the iface_ready callback */
+void kb_link_on_ready(bool ready);
+
+/* Feed IN transfer completions, from the input_report_done callback */
+void kb_link_report_done(void);
+
+/*
+ * Get the connection state and recovery statistics.
+ *
+ * @param stats Set to the statistics
+ */
+void kb_link_get(struct kb_link_stats *stats);
+
+/* Printable state name */
+const char *kb_link_state_str(enum kb_link_state state);
+
+#endif /* KEYBOARD_KB_LINK_H */
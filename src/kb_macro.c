@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Dynamic macros recorded at runtime
+ *
+ * Transitions are encoded straight from the key event into the buffer
+ * as two LEB128 varints: the key, (code << 2 | matrix flag << 1 |
+ * pressed) with the matrix flag taken from bit 15 of the code, and the
+ * milliseconds since the previous transition. A matrix key typed at a
+ * normal pace takes two to three bytes.
+ *
+ * Only whole key strokes are kept. A release whose press came before
+ * the recording started is skipped, and when the recording stops the
+ * presses of keys still held are cut out of it: the key stopping it,
+ * the layer key held to reach DM_REC. Each cut transition's delay moves
+ * to the next one. Playback stopped early releases the keys it pressed.
+ *
+ * Playback sends one transition per completed IN transfer, so the host
+ * sees every transition in its own report, and never earlier than its
+ * recorded time. If a transition does not lead to a report the next one
+ * follows after PLAY_FALLBACK_MS.
+ */
+
+#include "kb_macro.h"
+#include "kb_stamp.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(kb_macro, CONFIG_KEYBOARD_LOG_LEVEL);
+
+#define MACRO_SIZE CONFIG_KEYBOARD_DYNAMIC_MACRO_SIZE
+/* A 32-bit varint takes at most five bytes */
+#define MACRO_ENTRY_MAX 10
+#define PLAY_FALLBACK_MS 10
+/* Keys held at once while recording or playing */
+#define MACRO_HELD_MAX 16
+
+static uint8_t macro_buf[MACRO_SIZE];
+static struct k_spinlock macro_lock;
+static enum kb_macro_state macro_state;
+static uint32_t macro_len;
+static uint32_t macro_transitions;
+static uint32_t macro_duration_ms;
+/* Recording: time, offset and delta of the last transition */
+static uint32_t record_at;
+/* Recording: keys pressed and not released, with the offset of the press */
+static uint16_t record_held[MACRO_HELD_MAX];
+static uint32_t record_held_pos[MACRO_HELD_MAX];
+static uint8_t record_held_count;
+/* Playback: read offset, next transition and its due time */
+static uint32_t play_pos;
+static uint32_t play_entry;
+static uint32_t play_due;
+/* Playback: keys pressed and not released yet */
+static uint16_t play_held[MACRO_HELD_MAX];
+static uint8_t play_held_count;
+static kb_macro_play_cb_t macro_cb;
+
+static void macro_play_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(macro_play_work, macro_play_handler);
+
+/* Time left until the next transition is due */
+static k_timeout_t macro_play_wait(void)
+{
+	int32_t left = (int32_t)(play_due - k_uptime_get_32());
+
+	return left > 0 ? K_MSEC(left) : K_NO_WAIT;
+}
+
+static uint32_t varint_put(uint8_t *buf, uint32_t v)
+{
+	uint32_t n = 0;
+
+	while (v >= 0x80) {
+		buf[n++] = (v & 0x7f) | 0x80;
+		v >>= 7;
+	}
+	buf[n++] = v;
+
+	return n;
+}
+
+static uint32_t varint_get(const uint8_t *buf, uint32_t *v)
+{
+	uint32_t n = 0;
+	uint32_t shift = 0;
+
+	*v = 0;
+	do {
+		*v |= (uint32_t)(buf[n] & 0x7f) << shift;
+		shift += 7;
+	} while (buf[n++] & 0x80);
+
+	return n;
+}
+
+/* Index of code in a held key list, -1 if it is not held */
+static int held_find(const uint16_t *held, uint8_t count, uint16_t code)
+{
+	for (int i = 0; i < count; i++) {
+		if (held[i] == code) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/* Cut the presses of the keys still held out of the recording */
+static void record_trim(void)
+{
+	uint32_t in = macro_len;
+	uint32_t out;
+	uint32_t carry = 0;
+
+	for (int i = 0; i < record_held_count; i++) {
+		in = MIN(in, record_held_pos[i]);
+	}
+
+	out = in;
+	while (in < macro_len) {
+		uint32_t pos = in;
+		uint32_t entry;
+		uint32_t delta;
+		bool held = false;
+
+		in += varint_get(&macro_buf[in], &entry);
+		in += varint_get(&macro_buf[in], &delta);
+
+		for (int i = 0; i < record_held_count; i++) {
+			held = held || record_held_pos[i] == pos;
+		}
+
+		if (held) {
+			carry += delta;
+			macro_transitions--;
+			continue;
+		}
+
+		/* Never longer than the transitions cut before it */
+		out += varint_put(&macro_buf[out], entry);
+		out += varint_put(&macro_buf[out], delta + carry);
+		carry = 0;
+	}
+
+	macro_len = out;
+	macro_duration_ms -= carry;
+	record_held_count = 0;
+}
+
+void kb_macro_init(kb_macro_play_cb_t cb)
+{
+	macro_cb = cb;
+}
+
+int kb_macro_record_start(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&macro_lock);
+
+	if (macro_state == KB_MACRO_PLAYING) {
+		k_spin_unlock(&macro_lock, key);
+		return -EBUSY;
+	}
+
+	macro_len = 0;
+	macro_transitions = 0;
+	macro_duration_ms = 0;
+	record_at = k_uptime_get_32();
+	record_held_count = 0;
+	macro_state = KB_MACRO_RECORDING;
+	k_spin_unlock(&macro_lock, key);
+
+	LOG_INF("Recording macro");
+
+	return 0;
+}
+
+int kb_macro_record_stop(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&macro_lock);
+
+	if (macro_state != KB_MACRO_RECORDING) {
+		k_spin_unlock(&macro_lock, key);
+		return -EALREADY;
+	}
+
+	record_trim();
+	macro_state = KB_MACRO_IDLE;
+	k_spin_unlock(&macro_lock, key);
+
+	LOG_INF("Recorded %u transitions in %u bytes", macro_transitions, macro_len);
+
+	return 0;
+}
+
+int kb_macro_record_toggle(void)
+{
+	if (macro_state == KB_MACRO_RECORDING) {
+		return kb_macro_record_stop();
+	}
+
+	return kb_macro_record_start();
+}
+
+void kb_macro_record(uint16_t code, bool pressed, uint32_t stamp)
+{
+	k_spinlock_key_t key;
+	uint32_t now;
+	int held;
+
+	if (macro_state != KB_MACRO_RECORDING) {
+		return;
+	}
+
+	key = k_spin_lock(&macro_lock);
+	if (macro_state != KB_MACRO_RECORDING) {
+		k_spin_unlock(&macro_lock, key);
+		return;
+	}
+
+	held = held_find(record_held, record_held_count, code);
+	if (pressed ? held >= 0 || record_held_count == MACRO_HELD_MAX : held < 0) {
+		/* Pressed again, too many keys, or pressed before the recording */
+		k_spin_unlock(&macro_lock, key);
+		return;
+	}
+
+	if (macro_len + MACRO_ENTRY_MAX > MACRO_SIZE) {
+		record_trim();
+		macro_state = KB_MACRO_IDLE;
+		k_spin_unlock(&macro_lock, key);
+		LOG_WRN("Macro buffer full, recording stopped");
+		return;
+	}
+
+	/* Timed from detection, the handling delay is not part of the macro */
+	now = kb_stamp_uptime_ms(stamp);
+	if ((int32_t)(now - record_at) < 0) {
+		/* Detected before the previous transition was recorded */
+		now = record_at;
+	}
+	if (pressed) {
+		record_held[record_held_count] = code;
+		record_held_pos[record_held_count] = macro_len;
+		record_held_count++;
+	} else {
+		record_held_count--;
+		record_held[held] = record_held[record_held_count];
+		record_held_pos[held] = record_held_pos[record_held_count];
+	}
+
+	macro_len += varint_put(&macro_buf[macro_len],
+				(uint32_t)(code & 0x7fff) << 2 | (code >> 15) << 1 | pressed);
+	macro_len += varint_put(&macro_buf[macro_len], now - record_at);
+	macro_duration_ms += now - record_at;
+	macro_transitions++;
+	record_at = now;
+	k_spin_unlock(&macro_lock, key);
+}
+
+/* Decode the next transition, due delta ms after now. False at the end */
+static bool macro_play_next(uint32_t now)
+{
+	uint32_t delta;
+
+	if (play_pos >= macro_len) {
+		return false;
+	}
+
+	play_pos += varint_get(&macro_buf[play_pos], &play_entry);
+	play_pos += varint_get(&macro_buf[play_pos], &delta);
+	play_due = now + delta;
+
+	return true;
+}
+
+int kb_macro_play(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&macro_lock);
+
+	if (macro_state != KB_MACRO_IDLE) {
+		k_spin_unlock(&macro_lock, key);
+		return -EBUSY;
+	}
+
+	if (macro_len == 0U) {
+		k_spin_unlock(&macro_lock, key);
+		return -ENODATA;
+	}
+
+	macro_state = KB_MACRO_PLAYING;
+	play_pos = 0;
+	play_held_count = 0;
+	(void)macro_play_next(k_uptime_get_32());
+	k_spin_unlock(&macro_lock, key);
+
+	k_work_reschedule(&macro_play_work, macro_play_wait());
+
+	return 0;
+}
+
+void kb_macro_stop(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&macro_lock);
+	uint16_t held[MACRO_HELD_MAX];
+	uint8_t count = 0;
+
+	if (macro_state == KB_MACRO_PLAYING) {
+		macro_state = KB_MACRO_IDLE;
+		count = play_held_count;
+		memcpy(held, play_held, count * sizeof(held[0]));
+		play_held_count = 0;
+	}
+	k_spin_unlock(&macro_lock, key);
+
+	k_work_cancel_delayable(&macro_play_work);
+
+	/* Nothing the macro pressed stays pressed */
+	for (uint8_t i = 0; i < count; i++) {
+		macro_cb(held[i], false);
+	}
+}
+
+static void macro_play_handler(struct k_work *work)
+{
+	k_spinlock_key_t key = k_spin_lock(&macro_lock);
+	uint32_t now = k_uptime_get_32();
+	uint32_t entry;
+	uint16_t code;
+	int held;
+	bool more;
+
+	ARG_UNUSED(work);
+
+	if (macro_state != KB_MACRO_PLAYING) {
+		k_spin_unlock(&macro_lock, key);
+		return;
+	}
+
+	if ((int32_t)(play_due - now) > 0) {
+		k_spin_unlock(&macro_lock, key);
+		k_work_reschedule(&macro_play_work, macro_play_wait());
+		return;
+	}
+
+	entry = play_entry;
+	code = (entry >> 2) | (entry & BIT(1)) << 14;
+	held = held_find(play_held, play_held_count, code);
+	if ((entry & BIT(0)) != 0U && held < 0 && play_held_count < MACRO_HELD_MAX) {
+		play_held[play_held_count++] = code;
+	} else if ((entry & BIT(0)) == 0U && held >= 0) {
+		play_held[held] = play_held[--play_held_count];
+	}
+	more = macro_play_next(now);
+	if (!more) {
+		macro_state = KB_MACRO_IDLE;
+	}
+	k_spin_unlock(&macro_lock, key);
+
+	macro_cb(code, entry & BIT(0));
+
+	if (more) {
+		/* Normally the completion of this transition's report comes first */
+		k_work_reschedule(&macro_play_work,
+				  K_MSEC(MAX(PLAY_FALLBACK_MS, (int32_t)(play_due - now))));
+	}
+}
+
+void kb_macro_report_done(void)
+{
+	if (macro_state != KB_MACRO_PLAYING) {
+		return;
+	}
+
+	/* The host has the previous transition, the next may follow */
+	k_work_reschedule(&macro_play_work, macro_play_wait());
+}
+
+void kb_macro_get(struct kb_macro_info *info)
+{
+	k_spinlock_key_t key = k_spin_lock(&macro_lock);
+
+	info->state = macro_state;
+	info->transitions = macro_transitions;
+	info->bytes = macro_len;
+	info->capacity = MACRO_SIZE;
+	info->duration_ms = macro_duration_ms;
+	k_spin_unlock(&macro_lock, key);
+}
+
+#ifdef CONFIG_KEYBOARD_SHELL
+static const char *const macro_state_str[] = {
+	[KB_MACRO_IDLE] = "idle",
+	[KB_MACRO_RECORDING] = "recording",
+	[KB_MACRO_PLAYING] = "playing",
+};
+
+static int cmd_macro(const struct shell *sh, size_t argc, char **argv)
+{
+	struct kb_macro_info info;
+	int ret = 0;
+
+	if (argc > 1) {
+		if (strcmp(argv[1], "record") == 0) {
+			ret = kb_macro_record_start();
+		} else if (strcmp(argv[1], "stop") == 0) {
+			if (kb_macro_record_stop() != 0) {
+				kb_macro_stop();
+			}
+		} else if (strcmp(argv[1], "play") == 0) {
+			ret = kb_macro_play();
+		} else {
+			shell_error(sh, "Unknown argument %s", argv[1]);
+			return -EINVAL;
+		}
+
+		if (ret != 0) {
+			shell_error(sh, "Failed, %d", ret);
+		}
+		return ret;
+	}
+
+	kb_macro_get(&info);
+
+	shell_print(sh, "state:       %s", macro_state_str[info.state]);
+	shell_print(sh, "transitions: %u", info.transitions);
+	shell_print(sh, "size:        %u of %u bytes", info.bytes, info.capacity);
+	shell_print(sh, "duration:    %u ms", info.duration_ms);
+
+	return 0;
+}
+
+SHELL_SUBCMD_ADD((kb), macro, NULL,
+		 "Show the dynamic macro [record|stop|play]",
+		 cmd_macro, 1, 1);
+#endif /* CONFIG_KEYBOARD_SHELL */
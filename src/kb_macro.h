@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Dynamic macros recorded at runtime
+ */
+
+#ifndef KEYBOARD_KB_MACRO_H
+#define KEYBOARD_KB_MACRO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum kb_macro_state {
+	KB_MACRO_IDLE,
+	KB_MACRO_RECORDING,
+	KB_MACRO_PLAYING,
+};
+
+struct kb_macro_info {
+	enum kb_macro_state state;
+	uint32_t transitions;
+	/* Encoded size and buffer size in bytes */
+	uint32_t bytes;
+	uint32_t capacity;
+	/* Time from the start of the recording to the last transition */
+	uint32_t duration_ms;
+};
+
+/*
+ * Called with each transition during playback. Feeds it into the key
+ * event path like an input event.
+ */
+typedef void (*kb_macro_play_cb_t)(uint16_t code, bool pressed);
+
+/*
+ * Set the callback replaying transitions.
+ *
+ * @param cb Called from the system work queue
+ */
+void kb_macro_init(kb_macro_play_cb_t cb);
+
+/*
+ * Start recording, replacing the previous macro.
+ *
+ * @return 0 on success, -EBUSY while playing
+ */
+int kb_macro_record_start(void);
+
+/*
+ * Stop recording. The presses of keys still held, whose releases were
+ * not recorded, are dropped from the macro.
+ *
+ * @return 0 on success, -EALREADY if not recording
+ */
+int kb_macro_record_stop(void);
+
+/*
+ * Start recording, or stop it, for a key bound to DM_REC. The press of
+ * the key that stops the recording, and of a layer key held to reach
+ * it, are dropped from it.
+ *
+ * @return 0 on success, -EBUSY while playing
+ */
+int kb_macro_record_toggle(void);
+
+/*
+ * Record a key transition, from the key event path. Does nothing unless
+ * recording.
+ *
+ * @param code Key event code
+ * @param pressed True on press, false on release
+ * @param stamp Detection stamp of the event, see kb_stamp.h
+ */
+void kb_macro_record(uint16_t code, bool pressed, uint32_t stamp);
+
+/*
+ * Replay the macro with its recorded timing.
+ *
+ * @return 0 on success, -EBUSY if recording or playing, -ENODATA if
+ *         nothing is recorded
+ */
+int kb_macro_play(void);
+
+/* Stop playback, releasing the keys the macro left pressed */
+void kb_macro_stop(void);
+
+/* Pace playback by the host, from the input_report_done callback */
+void kb_macro_report_done(void);
+
+/*
+ * Get the macro state and size.
+ *
+ * @param info Set to the information
+ */
+void kb_macro_get(struct kb_macro_info *info);
+
+#endif /* KEYBOARD_KB_MACRO_H */
@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Key matrix scanned on a hardware counter period
+ *
+ * gpio-kbd-matrix sleeps between scans, so its period is a multiple of
+ * the kernel tick, given in milliseconds and never below 1 ms. Here a
+ * counter runs with its top value set to the scan period and its wrap
+ * interrupt only wakes the scan thread. The counter reloads in hardware,
+ * so the scans start at exact multiples of the period however long the
+ * previous one took and the rate never drifts from the counter clock.
+ *
+ * The scan thread reads the counter when it starts and when it is done.
+ * The first value is the delay since the wrap, whose spread is the scan
+ * jitter. A scan still running at the next wrap, or a wrap the thread
+ * had no time to take, counts as an overrun.
+ *
+ * Debouncing counts whole scans: a key is reported once it read the
+ * same new level in every scan for the debounce time. Keys that read
+ * as before cost one XOR per column. The first scan of that run is
+ * stamped and reported ahead of the key, so latencies downstream count
+ * the debounce time too.
+ */
+
+#include "kb_matrix.h"
+#include "kb_stamp.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/counter.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/input/input.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(kb_matrix, CONFIG_KEYBOARD_LOG_LEVEL);
+
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(timer_kbd_matrix) == 1,
+	     "Exactly one timer-kbd-matrix node is supported");
+BUILD_ASSERT(KB_MATRIX_ROWS <= 16, "At most 16 rows are supported");
+
+#define MATRIX_SETTLE_US DT_PROP(KB_MATRIX_NODE, settle_time_us)
+#define MATRIX_DEBOUNCE_DOWN_US DT_PROP(KB_MATRIX_NODE, debounce_down_us)
+#define MATRIX_DEBOUNCE_UP_US DT_PROP(KB_MATRIX_NODE, debounce_up_us)
+
+#define MATRIX_GPIO_SPEC(node_id, prop, idx) GPIO_DT_SPEC_GET_BY_IDX(node_id, prop, idx),
+
+static const struct gpio_dt_spec matrix_cols[] = {
+	DT_FOREACH_PROP_ELEM(KB_MATRIX_NODE, col_gpios, MATRIX_GPIO_SPEC)
+};
+
+static const struct gpio_dt_spec matrix_rows[] = {
+	DT_FOREACH_PROP_ELEM(KB_MATRIX_NODE, row_gpios, MATRIX_GPIO_SPEC)
+};
+
+static const struct device *const matrix_counter =
+	DEVICE_DT_GET(DT_PHANDLE(KB_MATRIX_NODE, counter));
+
+/* Set when all rows are on one port, read with a single port access */
+static const struct device *matrix_row_port;
+
+/* Debounced rows of each column */
+static uint16_t matrix_state[KB_MATRIX_COLS];
+/* Keys that read differently than their debounced state lately */
+static uint16_t matrix_pending[KB_MATRIX_COLS];
+/* Consecutive scans a pending key read its new level */
+static uint8_t matrix_count[KB_MATRIX_COLS][KB_MATRIX_ROWS];
+/* kb_stamp() of the first of the consecutive scans counted */
+static uint32_t matrix_seen[KB_MATRIX_COLS][KB_MATRIX_ROWS];
+static uint8_t matrix_down_scans;
+static uint8_t matrix_up_scans;
+
+static K_SEM_DEFINE(matrix_sem, 0, 1);
+static struct k_spinlock matrix_lock;
+
+static uint32_t matrix_freq;
+static uint32_t matrix_top;
+static uint32_t matrix_period_us;
+static bool matrix_counting_up;
+
+static atomic_t matrix_overruns;
+static uint32_t matrix_scans;
+static uint32_t matrix_start_min;
+static uint32_t matrix_start_max;
+static uint64_t matrix_start_sum;
+static uint32_t matrix_start_count;
+static uint32_t matrix_scan_ticks;
+
+/* Counter top value interrupt, once per period */
+static void matrix_period(const struct device *counter, void *user_data)
+{
+	ARG_UNUSED(counter);
+	ARG_UNUSED(user_data);
+
+	if (k_sem_count_get(&matrix_sem) != 0U) {
+		/* The previous period was never scanned */
+		atomic_inc(&matrix_overruns);
+	}
+	k_sem_give(&matrix_sem);
+}
+
+static uint32_t matrix_since_wrap(void)
+{
+	uint32_t ticks = 0;
+
+	(void)counter_get_value(matrix_counter, &ticks);
+
+	return matrix_counting_up ? ticks : matrix_top - ticks;
+}
+
+static uint16_t matrix_read_rows(void)
+{
+	gpio_port_value_t value;
+	uint16_t rows = 0;
+
+	if (matrix_row_port != NULL && gpio_port_get(matrix_row_port, &value) == 0) {
+		for (size_t r = 0; r < ARRAY_SIZE(matrix_rows); r++) {
+			rows |= ((value >> matrix_rows[r].pin) & 1U) << r;
+		}
+		return rows;
+	}
+
+	for (size_t r = 0; r < ARRAY_SIZE(matrix_rows); r++) {
+		if (gpio_pin_get_dt(&matrix_rows[r]) > 0) {
+			rows |= BIT(r);
+		}
+	}
+
+	return rows;
+}
+
+static void matrix_report(const struct device *dev, uint8_t row, uint8_t col,
+			  bool pressed)
+{
+	kb_stamp_report(dev, matrix_seen[col][row]);
+	input_report_abs(dev, INPUT_ABS_X, col, false, K_FOREVER);
+	input_report_abs(dev, INPUT_ABS_Y, row, false, K_FOREVER);
+	input_report_key(dev, INPUT_BTN_TOUCH, pressed, true, K_FOREVER);
+}
+
+static void matrix_debounce(const struct device *dev, uint8_t col, uint16_t rows)
+{
+	uint16_t diff = rows ^ matrix_state[col];
+	uint16_t check = diff | matrix_pending[col];
+
+	while (check != 0U) {
+		uint8_t row = find_lsb_set(check) - 1;
+		uint16_t bit = BIT(row);
+		bool pressed = (rows & bit) != 0U;
+
+		check &= ~bit;
+
+		if ((diff & bit) == 0U) {
+			/* Bounced back before the debounce time */
+			matrix_count[col][row] = 0;
+			matrix_pending[col] &= ~bit;
+			continue;
+		}
+
+		if (matrix_count[col][row] == 0U) {
+			matrix_seen[col][row] = kb_stamp();
+		}
+
+		if (++matrix_count[col][row] < (pressed ? matrix_down_scans : matrix_up_scans)) {
+			matrix_pending[col] |= bit;
+			continue;
+		}
+
+		matrix_count[col][row] = 0;
+		matrix_pending[col] &= ~bit;
+		matrix_state[col] ^= bit;
+		matrix_report(dev, row, col, pressed);
+	}
+}
+
+static void matrix_scan(const struct device *dev)
+{
+	for (uint8_t col = 0; col < KB_MATRIX_COLS; col++) {
+		uint16_t rows;
+
+		gpio_pin_set_dt(&matrix_cols[col], 1);
+		k_busy_wait(MATRIX_SETTLE_US);
+		rows = matrix_read_rows();
+		gpio_pin_set_dt(&matrix_cols[col], 0);
+
+		matrix_debounce(dev, col, rows);
+	}
+}
+
+static void matrix_account(uint32_t start, uint32_t end)
+{
+	k_spinlock_key_t lock = k_spin_lock(&matrix_lock);
+
+	matrix_scans++;
+
+	if (end < start) {
+		/* The counter wrapped while scanning */
+		atomic_inc(&matrix_overruns);
+		matrix_scan_ticks = end + matrix_top - start;
+	} else {
+		matrix_scan_ticks = end - start;
+	}
+
+	matrix_start_min = MIN(matrix_start_min, start);
+	matrix_start_max = MAX(matrix_start_max, start);
+	matrix_start_sum += start;
+	matrix_start_count++;
+
+	k_spin_unlock(&matrix_lock, lock);
+}
+
+static void matrix_thread(void *p1, void *p2, void *p3)
+{
+	const struct device *dev = p1;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		uint32_t start;
+
+		k_sem_take(&matrix_sem, K_FOREVER);
+		start = matrix_since_wrap();
+		matrix_scan(dev);
+		matrix_account(start, matrix_since_wrap());
+	}
+}
+
+K_THREAD_STACK_DEFINE(matrix_stack, CONFIG_KEYBOARD_MATRIX_STACK_SIZE);
+static struct k_thread matrix_thread_data;
+
+static uint32_t matrix_ticks_to_ns(uint64_t ticks)
+{
+	return ticks * NSEC_PER_SEC / matrix_freq;
+}
+
+void kb_matrix_stats_reset(void)
+{
+	k_spinlock_key_t lock = k_spin_lock(&matrix_lock);
+
+	atomic_set(&matrix_overruns, 0);
+	matrix_start_min = UINT32_MAX;
+	matrix_start_max = 0;
+	matrix_start_sum = 0;
+	matrix_start_count = 0;
+
+	k_spin_unlock(&matrix_lock, lock);
+}
+
+void kb_matrix_stats_get(struct kb_matrix_stats *stats)
+{
+	k_spinlock_key_t lock = k_spin_lock(&matrix_lock);
+	bool any = matrix_start_count != 0U;
+
+	stats->scans = matrix_scans;
+	stats->overruns = atomic_get(&matrix_overruns);
+	stats->period_us = matrix_period_us;
+	stats->start_min_ns = any ? matrix_ticks_to_ns(matrix_start_min) : 0;
+	stats->start_max_ns = any ? matrix_ticks_to_ns(matrix_start_max) : 0;
+	stats->start_avg_ns = any ? matrix_ticks_to_ns(matrix_start_sum / matrix_start_count) : 0;
+	stats->scan_ns = matrix_ticks_to_ns(matrix_scan_ticks);
+
+	k_spin_unlock(&matrix_lock, lock);
+}
+
+int kb_matrix_set_period(uint32_t us)
+{
+	uint64_t ticks = counter_us_to_ticks(matrix_counter, us);
+	uint32_t down = MAX(DIV_ROUND_UP(MATRIX_DEBOUNCE_DOWN_US, us), 1);
+	uint32_t up = MAX(DIV_ROUND_UP(MATRIX_DEBOUNCE_UP_US, us), 1);
+	struct counter_top_cfg top = {
+		.callback = matrix_period,
+		.user_data = NULL,
+		.flags = 0,
+	};
+	k_spinlock_key_t lock;
+	int ret;
+
+	if (us == 0U || ticks < 2U || ticks > counter_get_max_top_value(matrix_counter) ||
+	    down > UINT8_MAX || up > UINT8_MAX) {
+		return -EINVAL;
+	}
+
+	top.ticks = ticks;
+	ret = counter_set_top_value(matrix_counter, &top);
+	if (ret) {
+		return ret;
+	}
+
+	lock = k_spin_lock(&matrix_lock);
+	matrix_top = ticks;
+	matrix_period_us = us;
+	matrix_down_scans = down;
+	matrix_up_scans = up;
+	k_spin_unlock(&matrix_lock, lock);
+
+	kb_matrix_stats_reset();
+
+	return 0;
+}
+
+static int matrix_init(const struct device *dev)
+{
+	int ret;
+
+	if (!device_is_ready(matrix_counter)) {
+		LOG_ERR("Counter %s is not ready", matrix_counter->name);
+		return -ENODEV;
+	}
+
+	for (size_t c = 0; c < ARRAY_SIZE(matrix_cols); c++) {
+		if (!gpio_is_ready_dt(&matrix_cols[c])) {
+			LOG_ERR("Column GPIO is not ready");
+			return -ENODEV;
+		}
+
+		ret = gpio_pin_configure_dt(&matrix_cols[c], GPIO_OUTPUT_INACTIVE);
+		if (ret) {
+			return ret;
+		}
+	}
+
+	matrix_row_port = matrix_rows[0].port;
+	for (size_t r = 0; r < ARRAY_SIZE(matrix_rows); r++) {
+		if (!gpio_is_ready_dt(&matrix_rows[r])) {
+			LOG_ERR("Row GPIO is not ready");
+			return -ENODEV;
+		}
+
+		ret = gpio_pin_configure_dt(&matrix_rows[r], GPIO_INPUT);
+		if (ret) {
+			return ret;
+		}
+
+		if (matrix_rows[r].port != matrix_row_port) {
+			matrix_row_port = NULL;
+		}
+	}
+
+	matrix_freq = counter_get_frequency(matrix_counter);
+	matrix_counting_up = counter_is_counting_up(matrix_counter);
+
+	k_thread_create(&matrix_thread_data, matrix_stack,
+			K_THREAD_STACK_SIZEOF(matrix_stack), matrix_thread,
+			(void *)dev, NULL, NULL,
+			CONFIG_KEYBOARD_MATRIX_PRIORITY, 0, K_NO_WAIT);
+	k_thread_name_set(&matrix_thread_data, "kb_matrix");
+
+	ret = kb_matrix_set_period(DT_PROP(KB_MATRIX_NODE, scan_period_us));
+	if (ret) {
+		LOG_ERR("Counter cannot produce a %u us period, %d",
+			DT_PROP(KB_MATRIX_NODE, scan_period_us), ret);
+		return ret;
+	}
+
+	ret = counter_start(matrix_counter);
+	if (ret) {
+		LOG_ERR("Failed to start the counter, %d", ret);
+	}
+
+	return ret;
+}
+
+DEVICE_DT_DEFINE(KB_MATRIX_NODE, matrix_init, NULL, NULL, NULL,
+		 APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY, NULL);
+
+#ifdef CONFIG_KEYBOARD_SHELL
+static int cmd_matrix_show(const struct shell *sh, size_t argc, char **argv)
+{
+	struct kb_matrix_stats stats;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	kb_matrix_stats_get(&stats);
+	shell_print(sh, "period %u us, %u Hz counter, scans %u, overruns %u",
+		    stats.period_us, matrix_freq, stats.scans, stats.overruns);
+	shell_print(sh, "start after wrap min %u avg %u max %u ns, jitter %u ns",
+		    stats.start_min_ns, stats.start_avg_ns, stats.start_max_ns,
+		    stats.start_max_ns - stats.start_min_ns);
+	shell_print(sh, "scan %u ns, debounce %u down %u up scans",
+		    stats.scan_ns, matrix_down_scans, matrix_up_scans);
+
+	return 0;
+}
+
+static int cmd_matrix_period(const struct shell *sh, size_t argc, char **argv)
+{
+	uint32_t us = strtoul(argv[1], NULL, 0);
+	int ret;
+
+	ARG_UNUSED(argc);
+
+	ret = kb_matrix_set_period(us);
+	if (ret) {
+		shell_error(sh, "Cannot scan every %u us, %d", us, ret);
+	}
+
+	return ret;
+}
+
+static int cmd_matrix_reset(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	kb_matrix_stats_reset();
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_matrix,
+	SHELL_CMD(show, NULL, "Scan period, jitter and overruns", cmd_matrix_show),
+	SHELL_CMD_ARG(period, NULL, "Set the scan period <us>", cmd_matrix_period, 2, 0),
+	SHELL_CMD(reset, NULL, "Restart the jitter and overrun measurement",
+		  cmd_matrix_reset),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_SUBCMD_ADD((kb), matrix, &sub_matrix, "Timer scanned key matrix", NULL, 1, 0);
+#endif /* CONFIG_KEYBOARD_SHELL */
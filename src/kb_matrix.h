@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Key matrix scanned on a hardware counter period
+ */
+
+#ifndef KEYBOARD_KB_MATRIX_H
+#define KEYBOARD_KB_MATRIX_H
+
+#include <stdint.h>
+
+#include <zephyr/devicetree.h>
+
+#define KB_MATRIX_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(timer_kbd_matrix)
+
+#define KB_MATRIX_ROWS DT_PROP_LEN(KB_MATRIX_NODE, row_gpios)
+#define KB_MATRIX_COLS DT_PROP_LEN(KB_MATRIX_NODE, col_gpios)
+
+struct kb_matrix_stats {
+	uint32_t scans;
+	/* Periods that started before the previous scan was done */
+	uint32_t overruns;
+	uint32_t period_us;
+	/*
+	 * Delay from the counter wrap to the start of the scan, in
+	 * nanoseconds. max - min is the scan jitter.
+	 */
+	uint32_t start_min_ns;
+	uint32_t start_max_ns;
+	uint32_t start_avg_ns;
+	/* Duration of the last scan */
+	uint32_t scan_ns;
+};
+
+/*
+ * Change the scan period. The counter restarts from zero, the debounce
+ * times are converted to the new number of scans.
+ *
+ * @param us Scan period in microseconds
+ * @return 0 on success, -EINVAL if the counter cannot produce the
+ *         period or a debounce time no longer fits, or a counter error
+ */
+int kb_matrix_set_period(uint32_t us);
+
+void kb_matrix_stats_get(struct kb_matrix_stats *stats);
+
+/* Restart the start delay and overrun measurement */
+void kb_matrix_stats_reset(void);
+
+#endif /* KEYBOARD_KB_MATRIX_H */
@@ -0,0 +1,621 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Switch and wiring model of the key matrix on the GPIO emulator
+ *
+ * The model stands in for the switches of the board matrix on
+ * native_sim. The GPIO emulator runs the callbacks of an output pin
+ * whenever the pin changes, in the context of the code driving it, so a
+ * callback on every column works out the level of each row from the
+ * switch contacts at that instant and sets the emulated row inputs
+ * before the scanner reads them. The scanner itself runs unchanged,
+ * timer-kbd-matrix as well as gpio-kbd-matrix.
+ *
+ * A switch follows its key, except in the bounce after a transition:
+ * the bounce profile lists the contact intervals in microseconds,
+ * alternating between the new and the old level. With diodes a row is
+ * active when a closed switch connects it to an active column. Without,
+ * closed switches join rows and columns into nets. A net reaching an
+ * active column is active, unless it also reaches a column driven
+ * inactive, which holds it down and masks the keys. Columns left
+ * floating, as by gpio-kbd-matrix without col-drive-inactive, let
+ * ghost keys through.
+ *
+ * Scenarios are scripted key transitions, each stamped when its contact
+ * first changes. A report of the scanner that matches a pending
+ * transition gives the scan latency, bounce and debounce included. Any
+ * other report is a false trigger, a transition superseded or still
+ * pending at the end is missed. Without diodes, scenarios holding keys
+ * the wiring cannot tell apart are expected to go wrong instead: three
+ * keys on the corners of a rectangle always, two keys on one row where
+ * the scanner drives the inactive columns.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/input/input.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/printk.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(kb_matrix_emul, CONFIG_KEYBOARD_LOG_LEVEL);
+
+#define MODEL_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(kbd_matrix_emul)
+#define MODEL_MATRIX DT_PHANDLE(MODEL_NODE, matrix)
+#define MODEL_ROWS DT_PROP_LEN(MODEL_MATRIX, row_gpios)
+#define MODEL_COLS DT_PROP_LEN(MODEL_MATRIX, col_gpios)
+
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(kbd_matrix_emul) == 1,
+	     "Exactly one kbd-matrix-emul node is supported");
+BUILD_ASSERT(MODEL_ROWS <= 16 && MODEL_COLS <= 32,
+	     "At most 16 rows and 32 columns are supported");
+BUILD_ASSERT(MODEL_ROWS >= 6 && MODEL_COLS >= 17,
+	     "The scenarios are written for the 6x17 board matrix");
+
+/* Scenario timing, longer than the board debounce of 10 and 20 ms */
+#define MODEL_HOLD_MS 40
+#define MODEL_GAP_MS 40
+/* Wait for the last reports after a scenario */
+#define MODEL_SETTLE_MS 200
+
+struct model_profile {
+	const char *name;
+	/* Contact intervals after a transition (us), the first at the new level */
+	const uint16_t *press;
+	size_t press_len;
+	const uint16_t *release;
+	size_t release_len;
+	/* Contact opens for glitch_us this long into a press, 0 for never */
+	uint16_t glitch_at_us;
+	uint16_t glitch_us;
+};
+
+static const uint16_t bounce_typical_press[] = { 120, 60, 200, 90, 300, 50 };
+static const uint16_t bounce_typical_release[] = { 100, 50, 150 };
+static const uint16_t bounce_worn_press[] = { 300, 200, 500, 300, 800, 400, 1000, 300 };
+static const uint16_t bounce_worn_release[] = { 400, 300, 600, 200, 500 };
+
+/* In the order of the bounce-profile enum */
+static const struct model_profile model_profiles[] = {
+	{ "clean", NULL, 0, NULL, 0, 0, 0 },
+	{ "typical", bounce_typical_press, ARRAY_SIZE(bounce_typical_press),
+	  bounce_typical_release, ARRAY_SIZE(bounce_typical_release), 0, 0 },
+	{ "worn", bounce_worn_press, ARRAY_SIZE(bounce_worn_press),
+	  bounce_worn_release, ARRAY_SIZE(bounce_worn_release), 0, 0 },
+	{ "chatter", bounce_typical_press, ARRAY_SIZE(bounce_typical_press),
+	  bounce_typical_release, ARRAY_SIZE(bounce_typical_release), 8000, 3000 },
+};
+
+struct model_step {
+	uint8_t row;
+	uint8_t col;
+	bool pressed;
+	/* Wait after the transition */
+	uint16_t wait_ms;
+};
+
+#define MODEL_DOWN(r, c, ms) { (r), (c), true, (ms) }
+#define MODEL_UP(r, c, ms) { (r), (c), false, (ms) }
+#define MODEL_TAP(r, c) MODEL_DOWN(r, c, MODEL_HOLD_MS), MODEL_UP(r, c, MODEL_GAP_MS)
+
+/* Positions in keymap/tkl.keymap */
+static const struct model_step scenario_type[] = {
+	/* the quick brown fox */
+	MODEL_TAP(2, 5), MODEL_TAP(3, 6), MODEL_TAP(2, 3), MODEL_TAP(5, 6),
+	MODEL_TAP(2, 1), MODEL_TAP(2, 7), MODEL_TAP(2, 8), MODEL_TAP(4, 3),
+	MODEL_TAP(3, 8), MODEL_TAP(5, 6),
+	MODEL_TAP(4, 5), MODEL_TAP(2, 4), MODEL_TAP(2, 9), MODEL_TAP(2, 2),
+	MODEL_TAP(4, 6), MODEL_TAP(5, 6),
+	MODEL_TAP(3, 4), MODEL_TAP(2, 9), MODEL_TAP(4, 2), MODEL_TAP(3, 12),
+};
+
+/* "there" typed fast, each key pressed before the previous is let go */
+static const struct model_step scenario_roll[] = {
+	MODEL_DOWN(2, 5, 30), MODEL_DOWN(3, 6, 30), MODEL_UP(2, 5, 30),
+	MODEL_DOWN(2, 3, 30), MODEL_UP(3, 6, 30), MODEL_DOWN(2, 4, 30),
+	MODEL_UP(2, 3, 30), MODEL_DOWN(2, 3, 30), MODEL_UP(2, 4, 30),
+	MODEL_UP(2, 3, MODEL_GAP_MS),
+};
+
+/* Q, W and A on three corners of a rectangle, S on the fourth ghosts */
+static const struct model_step scenario_chord[] = {
+	MODEL_DOWN(2, 1, 20), MODEL_DOWN(2, 2, 20), MODEL_DOWN(3, 1, 100),
+	MODEL_UP(3, 1, MODEL_GAP_MS), MODEL_UP(2, 2, MODEL_GAP_MS),
+	MODEL_UP(2, 1, MODEL_GAP_MS),
+};
+
+/* Shift held over two letters, long enough for a glitch to show */
+static const struct model_step scenario_hold[] = {
+	MODEL_DOWN(4, 0, 60), MODEL_TAP(3, 1), MODEL_TAP(3, 2),
+	MODEL_UP(4, 0, MODEL_GAP_MS),
+};
+
+struct model_scenario {
+	const char *name;
+	const struct model_step *steps;
+	size_t len;
+	/* Two held keys share a row */
+	bool shared_row;
+	/* Three held keys sit on the corners of a rectangle */
+	bool rectangle;
+};
+
+static const struct model_scenario model_scenarios[] = {
+	{ "type", scenario_type, ARRAY_SIZE(scenario_type), false, false },
+	{ "roll", scenario_roll, ARRAY_SIZE(scenario_roll), true, false },
+	{ "chord", scenario_chord, ARRAY_SIZE(scenario_chord), true, true },
+	{ "hold", scenario_hold, ARRAY_SIZE(scenario_hold), false, false },
+};
+
+struct model_key {
+	/* Level the contact settles at */
+	bool pressed;
+	/* Last level the scanner reported */
+	bool reported;
+	/* The transition waits for its report */
+	bool pending;
+	/* Past bounce and glitch, the contact follows pressed */
+	bool settled;
+	/* k_cycle_get_32() at the transition */
+	uint32_t at;
+};
+
+struct model_stats {
+	uint32_t transitions;
+	uint32_t reported;
+	uint32_t matched;
+	uint32_t missed;
+	uint32_t false_triggers;
+	uint64_t latency_us;
+	uint32_t latency_max_us;
+};
+
+#define MODEL_GPIO_SPEC(node_id, prop, idx) GPIO_DT_SPEC_GET_BY_IDX(node_id, prop, idx),
+
+static const struct gpio_dt_spec model_cols[] = {
+	DT_FOREACH_PROP_ELEM(MODEL_MATRIX, col_gpios, MODEL_GPIO_SPEC)
+};
+
+static const struct gpio_dt_spec model_rows[] = {
+	DT_FOREACH_PROP_ELEM(MODEL_MATRIX, row_gpios, MODEL_GPIO_SPEC)
+};
+
+static struct gpio_callback model_col_cbs[MODEL_COLS];
+static struct model_key model_keys[MODEL_ROWS][MODEL_COLS];
+static struct k_spinlock model_lock;
+
+static const struct model_profile *model_profile =
+	&model_profiles[DT_ENUM_IDX(MODEL_NODE, bounce_profile)];
+static bool model_diodes = !DT_PROP(MODEL_NODE, no_diodes);
+/* The scanner drives the inactive columns rather than letting them float */
+static bool model_driven;
+
+static struct model_stats model_stats;
+/* Matrix position of the next BTN_TOUCH of the scanner */
+static uint16_t model_report_row;
+static uint16_t model_report_col;
+
+static K_SEM_DEFINE(model_start, 0, 1);
+/* Scenario requested from the shell, -1 for all */
+static int model_request;
+static bool model_running = IS_ENABLED(CONFIG_KEYBOARD_MATRIX_EMUL_RUN);
+
+/* Contact of a key switch at cycle now */
+static bool model_contact(struct model_key *key, uint32_t now)
+{
+	const struct model_profile *profile = model_profile;
+	const uint16_t *bounce = key->pressed ? profile->press : profile->release;
+	size_t len = key->pressed ? profile->press_len : profile->release_len;
+	uint32_t t;
+	uint32_t end = 0;
+
+	if (key->settled) {
+		return key->pressed;
+	}
+
+	t = k_cyc_to_us_floor32(now - key->at);
+
+	for (size_t i = 0; i < len; i++) {
+		end += bounce[i];
+		if (t < end) {
+			return key->pressed == (i % 2 == 0);
+		}
+	}
+
+	if (key->pressed && t >= profile->glitch_at_us &&
+	    t < profile->glitch_at_us + profile->glitch_us) {
+		return false;
+	}
+
+	if (!key->pressed || t >= profile->glitch_at_us + profile->glitch_us) {
+		key->settled = true;
+	}
+
+	return key->pressed;
+}
+
+/* Active rows, one bit each, for the current column outputs */
+static uint16_t model_eval(void)
+{
+	uint16_t closed[MODEL_COLS];
+	uint32_t now = k_cycle_get_32();
+	uint32_t active = 0;
+	uint32_t inactive = 0;
+	uint16_t rows = 0;
+
+	for (size_t c = 0; c < MODEL_COLS; c++) {
+		const struct gpio_dt_spec *col = &model_cols[c];
+		gpio_flags_t flags = 0;
+		bool level;
+
+		closed[c] = 0;
+		for (size_t r = 0; r < MODEL_ROWS; r++) {
+			if (model_contact(&model_keys[r][c], now)) {
+				closed[c] |= BIT(r);
+			}
+		}
+
+		(void)gpio_emul_flags_get(col->port, col->pin, &flags);
+		if ((flags & GPIO_OUTPUT) == 0U) {
+			/* Floating */
+			continue;
+		}
+
+		level = gpio_emul_output_get(col->port, col->pin) > 0;
+		if (level != ((col->dt_flags & GPIO_ACTIVE_LOW) != 0U)) {
+			active |= BIT(c);
+		} else {
+			inactive |= BIT(c);
+			model_driven = true;
+		}
+	}
+
+	while (active != 0U) {
+		uint8_t c = find_lsb_set(active) - 1;
+		uint32_t net_cols = BIT(c);
+		uint16_t net_rows = closed[c];
+		uint32_t grown;
+
+		active &= ~BIT(c);
+
+		if (model_diodes) {
+			rows |= net_rows;
+			continue;
+		}
+
+		/* Grow the net through closed switches until it stops */
+		do {
+			grown = net_cols;
+			for (size_t n = 0; n < MODEL_COLS; n++) {
+				if ((closed[n] & net_rows) != 0U) {
+					net_cols |= BIT(n);
+					net_rows |= closed[n];
+				}
+			}
+		} while (net_cols != grown);
+
+		if ((net_cols & inactive) == 0U) {
+			rows |= net_rows;
+		}
+	}
+
+	return rows;
+}
+
+static void model_update(void)
+{
+	k_spinlock_key_t lock = k_spin_lock(&model_lock);
+	uint16_t rows = model_eval();
+
+	k_spin_unlock(&model_lock, lock);
+
+	for (size_t r = 0; r < MODEL_ROWS; r++) {
+		const struct gpio_dt_spec *row = &model_rows[r];
+		bool active = (rows & BIT(r)) != 0U;
+
+		/* Fails until the scanner configured the row as input */
+		(void)gpio_emul_input_set(row->port, row->pin,
+					  active != ((row->dt_flags & GPIO_ACTIVE_LOW) != 0U));
+	}
+}
+
+/* A column output changed, in the scanner's context */
+static void model_col_changed(const struct device *port, struct gpio_callback *cb,
+			      gpio_port_pins_t pins)
+{
+	ARG_UNUSED(port);
+	ARG_UNUSED(cb);
+	ARG_UNUSED(pins);
+
+	model_update();
+}
+
+static void model_set_key(uint8_t row, uint8_t col, bool pressed)
+{
+	struct model_key *key = &model_keys[row][col];
+	k_spinlock_key_t lock = k_spin_lock(&model_lock);
+
+	if (key->pressed != pressed) {
+		if (key->pending) {
+			/* Changed again before the scanner reported it */
+			model_stats.missed++;
+		}
+		key->pressed = pressed;
+		key->pending = pressed != key->reported;
+		key->settled = false;
+		key->at = k_cycle_get_32();
+		model_stats.transitions++;
+	}
+
+	k_spin_unlock(&model_lock, lock);
+
+	/* A scanner idling with all columns driven only sees the rows */
+	model_update();
+}
+
+static void model_reported(uint16_t row, uint16_t col, bool pressed)
+{
+	struct model_key *key = &model_keys[row][col];
+	uint32_t now = k_cycle_get_32();
+	k_spinlock_key_t lock = k_spin_lock(&model_lock);
+
+	key->reported = pressed;
+	model_stats.reported++;
+
+	if (key->pending && pressed == key->pressed) {
+		uint32_t us = k_cyc_to_us_floor32(now - key->at);
+
+		key->pending = false;
+		model_stats.matched++;
+		model_stats.latency_us += us;
+		model_stats.latency_max_us = MAX(model_stats.latency_max_us, us);
+	} else {
+		model_stats.false_triggers++;
+	}
+
+	k_spin_unlock(&model_lock, lock);
+}
+
+static void model_input(struct input_event *evt, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	if (evt->type == INPUT_EV_ABS) {
+		if (evt->code == INPUT_ABS_X) {
+			model_report_col = evt->value;
+		} else if (evt->code == INPUT_ABS_Y) {
+			model_report_row = evt->value;
+		}
+		return;
+	}
+
+	if (evt->type != INPUT_EV_KEY || evt->code != INPUT_BTN_TOUCH ||
+	    model_report_row >= MODEL_ROWS || model_report_col >= MODEL_COLS) {
+		return;
+	}
+
+	model_reported(model_report_row, model_report_col, evt->value != 0);
+}
+
+INPUT_CALLBACK_DEFINE(DEVICE_DT_GET(MODEL_MATRIX), model_input, NULL);
+
+/*
+ * Play one scenario and print its results. True if nothing went wrong,
+ * or, when the wiring cannot tell the held keys apart, if something did.
+ */
+static bool model_run(const struct model_scenario *scenario)
+{
+	struct model_stats stats;
+	k_spinlock_key_t lock;
+	bool expect_errors;
+
+	lock = k_spin_lock(&model_lock);
+	memset(&model_stats, 0, sizeof(model_stats));
+	k_spin_unlock(&model_lock, lock);
+
+	for (size_t i = 0; i < scenario->len; i++) {
+		const struct model_step *step = &scenario->steps[i];
+
+		model_set_key(step->row, step->col, step->pressed);
+		k_msleep(step->wait_ms);
+	}
+
+	k_msleep(MODEL_SETTLE_MS);
+
+	lock = k_spin_lock(&model_lock);
+	for (size_t r = 0; r < MODEL_ROWS; r++) {
+		for (size_t c = 0; c < MODEL_COLS; c++) {
+			if (model_keys[r][c].pending) {
+				model_keys[r][c].pending = false;
+				model_stats.missed++;
+			}
+		}
+	}
+	stats = model_stats;
+	/* Ghosts where the columns float, masked keys where they are driven */
+	expect_errors = !model_diodes &&
+			(scenario->rectangle || (scenario->shared_row && model_driven));
+	k_spin_unlock(&model_lock, lock);
+
+	printk("kb_matrix_emul: {\"scenario\":\"%s\",\"profile\":\"%s\",\"diodes\":%s,"
+	       "\"expect_errors\":%s,\"transitions\":%u,\"reported\":%u,\"missed\":%u,"
+	       "\"false\":%u,\"false_permille\":%u,\"latency_avg_us\":%u,"
+	       "\"latency_max_us\":%u}\n",
+	       scenario->name, model_profile->name, model_diodes ? "true" : "false",
+	       expect_errors ? "true" : "false",
+	       stats.transitions, stats.reported, stats.missed, stats.false_triggers,
+	       stats.false_triggers * 1000U / MAX(stats.transitions, 1U),
+	       (uint32_t)(stats.latency_us / MAX(stats.matched, 1U)),
+	       stats.latency_max_us);
+
+	return (stats.missed == 0U && stats.false_triggers == 0U) != expect_errors;
+}
+
+/* Every scenario with every bounce profile */
+static bool model_run_all(void)
+{
+	const struct model_profile *profile = model_profile;
+	bool ok = true;
+
+	for (size_t p = 0; p < ARRAY_SIZE(model_profiles); p++) {
+		model_profile = &model_profiles[p];
+		for (size_t s = 0; s < ARRAY_SIZE(model_scenarios); s++) {
+			ok = model_run(&model_scenarios[s]) && ok;
+		}
+	}
+
+	model_profile = profile;
+
+	return ok;
+}
+
+static void model_thread(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	if (IS_ENABLED(CONFIG_KEYBOARD_MATRIX_EMUL_RUN)) {
+		printk("kb_matrix_emul: %s\n", model_run_all() ? "PASS" : "FAIL");
+		model_running = false;
+	}
+
+	while (true) {
+		k_sem_take(&model_start, K_FOREVER);
+
+		if (model_request < 0) {
+			for (size_t s = 0; s < ARRAY_SIZE(model_scenarios); s++) {
+				(void)model_run(&model_scenarios[s]);
+			}
+		} else {
+			(void)model_run(&model_scenarios[model_request]);
+		}
+
+		model_running = false;
+	}
+}
+
+/* Started once the scanner had time to configure its pins */
+K_THREAD_DEFINE(kb_matrix_model, 1024, model_thread, NULL, NULL, NULL,
+		K_LOWEST_APPLICATION_THREAD_PRIO, 0, 100);
+
+static int model_init(void)
+{
+	int ret;
+
+	for (size_t c = 0; c < MODEL_COLS; c++) {
+		gpio_init_callback(&model_col_cbs[c], model_col_changed,
+				   BIT(model_cols[c].pin));
+		ret = gpio_add_callback(model_cols[c].port, &model_col_cbs[c]);
+		if (ret) {
+			LOG_ERR("Failed to watch column %zu, %d", c, ret);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/* Before the scanner starts at the application level */
+SYS_INIT(model_init, POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY);
+
+#ifdef CONFIG_KEYBOARD_SHELL
+static int cmd_model_run(const struct shell *sh, size_t argc, char **argv)
+{
+	int request = -2;
+
+	if (strcmp(argv[1], "all") == 0) {
+		request = -1;
+	}
+
+	for (size_t s = 0; s < ARRAY_SIZE(model_scenarios); s++) {
+		if (strcmp(argv[1], model_scenarios[s].name) == 0) {
+			request = s;
+		}
+	}
+
+	if (request == -2) {
+		shell_error(sh, "Unknown scenario %s", argv[1]);
+		return -EINVAL;
+	}
+
+	if (model_running) {
+		shell_error(sh, "Already running");
+		return -EBUSY;
+	}
+
+	model_request = request;
+	model_running = true;
+	k_sem_give(&model_start);
+
+	return 0;
+}
+
+static int cmd_model_profile(const struct shell *sh, size_t argc, char **argv)
+{
+	if (argc < 2) {
+		shell_print(sh, "profile: %s", model_profile->name);
+		shell_print(sh, "diodes:  %s", model_diodes ? "yes" : "no");
+		return 0;
+	}
+
+	for (size_t p = 0; p < ARRAY_SIZE(model_profiles); p++) {
+		if (strcmp(argv[1], model_profiles[p].name) == 0) {
+			model_profile = &model_profiles[p];
+			return 0;
+		}
+	}
+
+	shell_error(sh, "Unknown profile %s", argv[1]);
+
+	return -EINVAL;
+}
+
+static int cmd_model_diodes(const struct shell *sh, size_t argc, char **argv)
+{
+	if (strcmp(argv[1], "on") != 0 && strcmp(argv[1], "off") != 0) {
+		shell_error(sh, "Expected on or off");
+		return -EINVAL;
+	}
+
+	model_diodes = strcmp(argv[1], "on") == 0;
+	model_update();
+
+	return 0;
+}
+
+static int cmd_model_key(const struct shell *sh, size_t argc, char **argv)
+{
+	unsigned long row = strtoul(argv[1], NULL, 0);
+	unsigned long col = strtoul(argv[2], NULL, 0);
+
+	if (row >= MODEL_ROWS || col >= MODEL_COLS) {
+		shell_error(sh, "Position must be below %d x %d", MODEL_ROWS, MODEL_COLS);
+		return -EINVAL;
+	}
+
+	model_set_key(row, col, strtoul(argv[3], NULL, 0) != 0);
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_model,
+	SHELL_CMD_ARG(run, NULL, "Play a scenario <type|roll|chord|hold|all>",
+		      cmd_model_run, 2, 0),
+	SHELL_CMD_ARG(profile, NULL,
+		      "Show or set the bounce profile [clean|typical|worn|chatter]",
+		      cmd_model_profile, 1, 1),
+	SHELL_CMD_ARG(diodes, NULL, "Switch diodes <on|off>", cmd_model_diodes, 2, 0),
+	SHELL_CMD_ARG(key, NULL, "Press or release a key <row> <col> <0|1>",
+		      cmd_model_key, 4, 0),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_SUBCMD_ADD((kb), model, &sub_model, "Key matrix model on the GPIO emulator",
+		 NULL, 1, 0);
+#endif /* CONFIG_KEYBOARD_SHELL */
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Key event path latency and execution time
+ *
+ * Every key event carries the stamp of its detection, see kb_stamp.h,
+ * and is stamped again when its handling starts. The latency to the end
+ * of the handling covers debouncing, the event queue or, with the
+ * run-to-completion engine, the wait for the event lock. The report
+ * queue keeps the stamp with the report, so the latency to the
+ * completed IN transfer includes the wait for the host's poll. The
+ * maximum handling time is the measured worst-case execution time of
+ * the chain.
+ */
+
+#include "kb_path.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+
+static struct k_spinlock path_lock;
+static uint32_t path_events;
+static uint64_t path_latency_cyc;
+static uint32_t path_latency_max_cyc;
+static uint64_t path_exec_cyc;
+static uint32_t path_exec_max_cyc;
+static uint32_t path_delivered;
+static uint64_t path_delivered_cyc;
+static uint32_t path_delivered_max_cyc;
+
+void kb_path_record(uint32_t detect_cyc, uint32_t start_cyc)
+{
+	uint32_t now = k_cycle_get_32();
+	uint32_t latency = now - detect_cyc;
+	uint32_t exec = now - start_cyc;
+	k_spinlock_key_t key = k_spin_lock(&path_lock);
+
+	path_events++;
+	path_latency_cyc += latency;
+	path_latency_max_cyc = MAX(path_latency_max_cyc, latency);
+	path_exec_cyc += exec;
+	path_exec_max_cyc = MAX(path_exec_max_cyc, exec);
+	k_spin_unlock(&path_lock, key);
+}
+
+void kb_path_record_delivered(uint32_t detect_cyc)
+{
+	uint32_t latency = k_cycle_get_32() - detect_cyc;
+	k_spinlock_key_t key = k_spin_lock(&path_lock);
+
+	path_delivered++;
+	path_delivered_cyc += latency;
+	path_delivered_max_cyc = MAX(path_delivered_max_cyc, latency);
+	k_spin_unlock(&path_lock, key);
+}
+
+void kb_path_get(struct kb_path_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&path_lock);
+	uint32_t events = MAX(path_events, 1U);
+	uint32_t delivered = MAX(path_delivered, 1U);
+
+	stats->events = path_events;
+	stats->latency_avg_us = k_cyc_to_us_floor32(path_latency_cyc / events);
+	stats->latency_max_us = k_cyc_to_us_floor32(path_latency_max_cyc);
+	stats->exec_avg_cyc = path_exec_cyc / events;
+	stats->exec_max_cyc = path_exec_max_cyc;
+	stats->delivered = path_delivered;
+	stats->delivered_avg_us = k_cyc_to_us_floor32(path_delivered_cyc / delivered);
+	stats->delivered_max_us = k_cyc_to_us_floor32(path_delivered_max_cyc);
+	k_spin_unlock(&path_lock, key);
+}
+
+#ifdef CONFIG_KEYBOARD_SHELL
+static int cmd_path(const struct shell *sh, size_t argc, char **argv)
+{
+	struct kb_path_stats stats;
+
+	if (argc > 1) {
+		k_spinlock_key_t key;
+
+		if (strcmp(argv[1], "reset") != 0) {
+			shell_error(sh, "Unknown argument %s", argv[1]);
+			return -EINVAL;
+		}
+
+		key = k_spin_lock(&path_lock);
+		path_events = 0;
+		path_latency_cyc = 0;
+		path_latency_max_cyc = 0;
+		path_exec_cyc = 0;
+		path_exec_max_cyc = 0;
+		path_delivered = 0;
+		path_delivered_cyc = 0;
+		path_delivered_max_cyc = 0;
+		k_spin_unlock(&path_lock, key);
+
+		return 0;
+	}
+
+	kb_path_get(&stats);
+
+	shell_print(sh, "engine:  %s", IS_ENABLED(CONFIG_KEYBOARD_RUN_TO_COMPLETION) ?
+		    "run-to-completion" : "threaded");
+	shell_print(sh, "events:  %u", stats.events);
+	shell_print(sh, "latency: avg %u us, max %u us, detection to handled",
+		    stats.latency_avg_us, stats.latency_max_us);
+	shell_print(sh, "fetched: %u reports, avg %u us, max %u us, detection to host",
+		    stats.delivered, stats.delivered_avg_us, stats.delivered_max_us);
+	shell_print(sh, "exec:    avg %u cycles, max %u cycles (%u us)",
+		    stats.exec_avg_cyc, stats.exec_max_cyc,
+		    k_cyc_to_us_floor32(stats.exec_max_cyc));
+
+	return 0;
+}
+
+SHELL_SUBCMD_ADD((kb), path, NULL,
+		 "Show key event latency and execution time [reset]",
+		 cmd_path, 1, 1);
+#endif /* CONFIG_KEYBOARD_SHELL */
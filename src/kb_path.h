@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Key event path latency and execution time
+ */
+
+#ifndef KEYBOARD_KB_PATH_H
+#define KEYBOARD_KB_PATH_H
+
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+
+struct kb_path_stats {
+	uint32_t events;
+	/* From the detection of the key change to the end of the handling */
+	uint32_t latency_avg_us;
+	uint32_t latency_max_us;
+	/* Handling alone: state update, report build and submit */
+	uint32_t exec_avg_cyc;
+	uint32_t exec_max_cyc;
+	/* From the detection to the completed IN transfer */
+	uint32_t delivered;
+	uint32_t delivered_avg_us;
+	uint32_t delivered_max_us;
+};
+
+#ifdef CONFIG_KEYBOARD_PATH_STATS
+
+/*
+ * Record a handled key event.
+ *
+ * @param detect_cyc Event stamp, see kb_stamp.h
+ * @param start_cyc kb_stamp() when the handling started
+ */
+void kb_path_record(uint32_t detect_cyc, uint32_t start_cyc);
+
+/*
+ * Record a report the host fetched.
+ *
+ * @param detect_cyc Stamp of the oldest key event in the report
+ */
+void kb_path_record_delivered(uint32_t detect_cyc);
+
+/*
+ * Get the statistics.
+ *
+ * @param stats Set to the statistics
+ */
+void kb_path_get(struct kb_path_stats *stats);
+
+#else
+
+static inline void kb_path_record(uint32_t detect_cyc, uint32_t start_cyc)
+{
+	ARG_UNUSED(detect_cyc);
+	ARG_UNUSED(start_cyc);
+}
+
+static inline void kb_path_record_delivered(uint32_t detect_cyc)
+{
+	ARG_UNUSED(detect_cyc);
+}
+
+#endif /* CONFIG_KEYBOARD_PATH_STATS */
+
+#endif /* KEYBOARD_KB_PATH_H */
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Key event pipeline, composed at compile time
+ */
+
+#ifndef KEYBOARD_KB_PIPELINE_H
+#define KEYBOARD_KB_PIPELINE_H
+
+#include "kb_keymap.h"
+#include "kb_macro.h"
+#include "kb_state.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+
+/* Event code flag, the rest is a matrix position for the generated keymap */
+#define KB_EVENT_MATRIX BIT(15)
+/* Rebuild the report without a key change, e.g. after a protocol switch */
+#define KB_EVENT_SYNC UINT16_MAX
+
+/*
+ * Run one key event through the stages enabled in this build, in order:
+ * dynamic macro recording, keymap for matrix positions, key state. Each
+ * stage's condition is a build-time constant and the function is always
+ * inlined into its caller, so a disabled stage leaves neither a call nor
+ * a branch. Within the keymap, stages for action types the layout does
+ * not use are removed the same way, see KB_KEYMAP_ACTION_TYPES. Stages
+ * that depend on time use the event's detection stamp, not the time it
+ * is handled.
+ *
+ * @param state Key state to update
+ * @param code INPUT_KEY_* code, matrix position with KB_EVENT_MATRIX or
+ *             KB_EVENT_SYNC
+ * @param pressed True on press, false on release
+ * @param stamp Detection stamp of the event, see kb_stamp.h
+ * @return 0 for KB_EVENT_SYNC, otherwise as kb_state_process() or
+ *         kb_keymap_process()
+ */
+static ALWAYS_INLINE int kb_pipeline_process(struct kb_state *state,
+					     uint16_t code, bool pressed,
+					     uint32_t stamp)
+{
+	if (code == KB_EVENT_SYNC) {
+		/* Nothing to update, only rebuild */
+		return 0;
+	}
+
+	if (IS_ENABLED(CONFIG_KEYBOARD_DYNAMIC_MACRO)) {
+		kb_macro_record(code, pressed, stamp);
+	}
+
+	if (IS_ENABLED(CONFIG_KEYBOARD_GENERATED_KEYMAP) &&
+	    (code & KB_EVENT_MATRIX) != 0) {
+		return kb_keymap_process(state, code & ~KB_EVENT_MATRIX, pressed, stamp);
+	}
+
+	return kb_state_process(state, code, pressed);
+}
+
+#endif /* KEYBOARD_KB_PIPELINE_H */
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Host polling cadence measurement
+ *
+ * The USB stack does not pass SOFs to applications, but an IN transfer
+ * completes exactly when the host polls the endpoint. While a probe runs
+ * the endpoint is kept armed, so the interval between completions, of
+ * any transfer on the device, is the host's real polling interval.
+ * Intervals longer than the configured period count as missed polls.
+ *
+ * Queued reports go first: the queue is kicked before the probe sees a
+ * completion, and the probe only re-submits the latest snapshot when the
+ * endpoint is still idle. -EBUSY means the next poll is carried by a
+ * queued report, so key changes during a probe reach the host in order
+ * and the probe carries on. Any other submit error aborts it.
+ */
+
+#include "kb_poll.h"
+#include "kb_snapshot.h"
+#include "kb_usb_stats.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/usb/udc_buf.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/usb/class/usbd_hid.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(kb_poll, CONFIG_KEYBOARD_LOG_LEVEL);
+
+UDC_STATIC_BUF_DEFINE(poll_report, KB_KBD_REPORT_MAX);
+
+static struct k_spinlock poll_lock;
+static const struct device *poll_dev;
+static uint32_t poll_remaining;
+static uint32_t poll_last_cyc;
+static bool poll_have_last;
+static uint64_t poll_sum_us;
+static struct kb_poll_stats poll_stats;
+
+static int poll_submit(void)
+{
+	size_t len;
+
+	kb_snapshot_read(poll_report, &len);
+
+	return kb_usb_submit(poll_dev, len, poll_report);
+}
+
+/* Submit unless the endpoint is busy, which carries the poll as well */
+static int poll_arm(void)
+{
+	int ret = poll_submit();
+
+	return ret == -EBUSY ? 0 : ret;
+}
+
+void kb_poll_probe_abort(int err)
+{
+	k_spinlock_key_t key = k_spin_lock(&poll_lock);
+	bool running = poll_stats.running;
+	uint32_t samples = poll_stats.samples;
+
+	if (running) {
+		poll_stats.running = false;
+		poll_stats.aborted = true;
+		poll_stats.error = err;
+	}
+	k_spin_unlock(&poll_lock, key);
+
+	if (running) {
+		LOG_WRN("Polling probe aborted after %u of %u intervals, error %d",
+			samples, poll_stats.requested, err);
+	}
+}
+
+void kb_poll_set_expected(uint32_t period_us)
+{
+	k_spinlock_key_t key = k_spin_lock(&poll_lock);
+
+	poll_stats.expected_us = period_us;
+	k_spin_unlock(&poll_lock, key);
+}
+
+int kb_poll_probe_start(const struct device *dev, uint32_t count)
+{
+	k_spinlock_key_t key = k_spin_lock(&poll_lock);
+	uint32_t expected_us = poll_stats.expected_us;
+	int ret;
+
+	if (poll_stats.running) {
+		k_spin_unlock(&poll_lock, key);
+		return -EBUSY;
+	}
+
+	poll_stats = (struct kb_poll_stats){
+		.min_us = UINT32_MAX,
+		.expected_us = expected_us,
+		.requested = count,
+		.running = true,
+	};
+	poll_dev = dev;
+	poll_remaining = count;
+	poll_have_last = false;
+	poll_sum_us = 0;
+	k_spin_unlock(&poll_lock, key);
+
+	ret = poll_arm();
+	if (ret != 0) {
+		kb_poll_probe_abort(ret);
+	}
+
+	return ret;
+}
+
+bool kb_poll_report_done(const struct device *dev, const uint8_t *report)
+{
+	uint32_t now = k_cycle_get_32();
+	k_spinlock_key_t key;
+	bool resubmit;
+
+	key = k_spin_lock(&poll_lock);
+
+	if (!poll_stats.running || dev != poll_dev) {
+		k_spin_unlock(&poll_lock, key);
+		return report == poll_report;
+	}
+
+	if (poll_have_last) {
+		uint32_t interval_us = k_cyc_to_us_floor32(now - poll_last_cyc);
+		uint32_t expected_us = poll_stats.expected_us;
+
+		poll_stats.samples++;
+		poll_stats.min_us = MIN(poll_stats.min_us, interval_us);
+		poll_stats.max_us = MAX(poll_stats.max_us, interval_us);
+		poll_sum_us += interval_us;
+		poll_stats.avg_us = poll_sum_us / poll_stats.samples;
+
+		if (expected_us != 0U && interval_us > expected_us + expected_us / 2U) {
+			poll_stats.missed += (interval_us + expected_us / 2U) / expected_us - 1U;
+		}
+
+		poll_remaining--;
+	}
+
+	poll_last_cyc = now;
+	poll_have_last = true;
+	resubmit = poll_remaining > 0U;
+	poll_stats.running = resubmit;
+	k_spin_unlock(&poll_lock, key);
+
+	if (resubmit) {
+		int ret = poll_arm();
+
+		if (ret != 0) {
+			kb_poll_probe_abort(ret);
+		}
+	}
+
+	return report == poll_report;
+}
+
+void kb_poll_get(struct kb_poll_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&poll_lock);
+
+	*stats = poll_stats;
+	if (stats->samples == 0U) {
+		stats->min_us = 0;
+	}
+
+	k_spin_unlock(&poll_lock, key);
+}
+
+#ifdef CONFIG_KEYBOARD_SHELL
+static int cmd_poll(const struct shell *sh, size_t argc, char **argv)
+{
+	const struct device *dev = DEVICE_DT_GET(DT_NODELABEL(hid_dev_0));
+	uint32_t count = CONFIG_KEYBOARD_POLL_PROBE_COUNT;
+	struct kb_poll_stats stats;
+	int ret;
+
+	if (argc > 1) {
+		count = strtoul(argv[1], NULL, 0);
+		if (count == 0U) {
+			shell_error(sh, "Invalid interval count");
+			return -EINVAL;
+		}
+	}
+
+	ret = kb_poll_probe_start(dev, count);
+	if (ret != 0) {
+		shell_error(sh, "Failed to start probe, %d", ret);
+		return ret;
+	}
+
+	/* A host polling slower than every 100 ms is broken anyway */
+	for (uint32_t waited = 0; waited < count * 100U; waited += 10U) {
+		kb_poll_get(&stats);
+		if (!stats.running) {
+			break;
+		}
+
+		k_msleep(10);
+	}
+
+	kb_poll_get(&stats);
+	if (stats.running) {
+		shell_warn(sh, "Probe still running, host is not polling");
+	} else if (stats.aborted) {
+		shell_warn(sh, "Probe aborted, error %d", stats.error);
+	}
+
+	shell_print(sh, "intervals: %u of %u%s", stats.samples, stats.requested,
+		    !stats.running && stats.samples < stats.requested ? ", partial" : "");
+	shell_print(sh, "period:    %u us configured, %u us effective",
+		    stats.expected_us, stats.avg_us);
+	shell_print(sh, "range:     %u..%u us", stats.min_us, stats.max_us);
+	shell_print(sh, "missed:    %u polls", stats.missed);
+
+	return 0;
+}
+
+SHELL_SUBCMD_ADD((kb, usb), poll, NULL,
+		 "Measure the host polling interval [intervals]",
+		 cmd_poll, 1, 1);
+#endif /* CONFIG_KEYBOARD_SHELL */
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Host polling cadence measurement
+ */
+
+#ifndef KEYBOARD_KB_POLL_H
+#define KEYBOARD_KB_POLL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/device.h>
+
+struct kb_poll_stats {
+	/* Completion intervals measured by the last probe */
+	uint32_t samples;
+	uint32_t min_us;
+	uint32_t avg_us;
+	uint32_t max_us;
+	/* Polls the host skipped, relative to the configured period */
+	uint32_t missed;
+	/* Configured IN polling period */
+	uint32_t expected_us;
+	/* Intervals the probe was started for, fewer were measured if aborted */
+	uint32_t requested;
+	bool running;
+	/* Ended by a submit error or the interface going down, see error */
+	bool aborted;
+	int error;
+};
+
+/*
+ * Set the polling period the host was asked for.
+ *
+ * @param period_us IN polling period in microseconds
+ */
+void kb_poll_set_expected(uint32_t period_us);
+
+/*
+ * Start a probe: the endpoint is kept armed from every transfer
+ * completion, by a queued report or else the current one, so each
+ * completion marks one host poll.
+ *
+ * @param dev HID device
+ * @param count Number of intervals to measure
+ * @return 0 on success, -EBUSY if a probe is running
+ */
+int kb_poll_probe_start(const struct device *dev, uint32_t count);
+
+/*
+ * Feed an IN transfer completion, from the input_report_done callback,
+ * after the report queue had its chance to submit.
+ *
+ * @param dev HID device of the transfer
+ * @param report Buffer of the completed transfer
+ * @return True if the transfer was submitted by the probe
+ */
+bool kb_poll_report_done(const struct device *dev, const uint8_t *report);
+
+/*
+ * End a running probe early and flag it as aborted.
+ *
+ * @param err Reason, negative errno
+ */
+void kb_poll_probe_abort(int err);
+
+/*
+ * Get the result of the last probe.
+ *
+ * @param stats Set to the statistics
+ */
+void kb_poll_get(struct kb_poll_stats *stats);
+
+#endif /* KEYBOARD_KB_POLL_H */
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * HID report builders
+ *
+ * The report sizes in kb_report.h follow the enabled features, the
+ * descriptor built in kb_report_desc.cpp is checked against them at
+ * compile time so both always describe the same layout.
+ */
+
+#include "kb_report.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/byteorder.h>
+
+/* Endpoint sizes in the devicetree must match the descriptor */
+#define KB_REPORT_CHECK_DT(node_id)							\
+	BUILD_ASSERT(DT_PROP(node_id, in_report_size) == KB_IN_REPORT_SIZE,		\
+		     "in-report-size of " DT_NODE_PATH(node_id)				\
+		     " does not match KB_IN_REPORT_SIZE");				\
+	BUILD_ASSERT(DT_PROP_OR(node_id, out_report_size, 0) == 0 ||			\
+		     DT_PROP_OR(node_id, out_report_size, 0) == KB_OUT_REPORT_SIZE,	\
+		     "out-report-size of " DT_NODE_PATH(node_id)			\
+		     " does not match KB_OUT_REPORT_SIZE");
+
+DT_FOREACH_STATUS_OKAY(zephyr_hid_device, KB_REPORT_CHECK_DT)
+
+#ifdef CONFIG_KEYBOARD_VENDOR_REPORT
+BUILD_ASSERT(CONFIG_KEYBOARD_VENDOR_REPORT_SIZE >= 15, "Vendor report too small for the status");
+#endif
+
+size_t kb_report_build_keyboard(const struct kb_state *state, bool boot, uint8_t *buf)
+{
+	uint8_t *payload = buf;
+
+	if (boot) {
+		kb_state_build_report(state, buf);
+		return KB_BOOT_REPORT_SIZE;
+	}
+
+	if (KB_REPORT_IDS) {
+		*payload++ = KB_REPORT_ID_KEYBOARD;
+	}
+
+#ifdef CONFIG_KEYBOARD_NKRO
+	payload[0] = state->modifiers;
+	memcpy(&payload[1], state->key_bitmap, KB_NKRO_BITMAP_SIZE);
+#else
+	kb_state_build_report(state, payload);
+#endif
+
+	return KB_KBD_REPORT_SIZE;
+}
+
+#ifdef CONFIG_KEYBOARD_CONSUMER
+size_t kb_report_build_consumer(const struct kb_state *state, uint8_t *buf)
+{
+	buf[0] = KB_REPORT_ID_CONSUMER;
+	sys_put_le16(state->consumer, &buf[1]);
+
+	return KB_CONSUMER_REPORT_SIZE;
+}
+#endif
+
+#ifdef CONFIG_KEYBOARD_VENDOR_REPORT
+size_t kb_report_build_vendor(const struct kb_report_status *status, uint8_t *buf)
+{
+	memset(buf, 0, KB_VENDOR_REPORT_SIZE);
+	buf[0] = KB_REPORT_ID_VENDOR;
+	/* Layout version, bumped when fields change */
+	buf[1] = 5;
+	buf[2] = status->protocol;
+	buf[3] = status->host;
+	sys_put_le32(status->evt_dropped, &buf[4]);
+	sys_put_le16(status->poll_us, &buf[8]);
+	sys_put_le16(status->poll_missed, &buf[10]);
+	sys_put_le16(status->usb_busy, &buf[12]);
+	sys_put_le16(status->usb_errors, &buf[14]);
+	buf[16] = status->poll_flags;
+
+	return KB_VENDOR_REPORT_SIZE;
+}
+#endif
+
+int kb_report_parse_leds(bool boot, uint16_t len, const uint8_t *buf)
+{
+	size_t offset = boot ? 0 : KB_REPORT_ID_SIZE;
+
+	if (len <= offset) {
+		return -EINVAL;
+	}
+
+	return buf[offset];
+}
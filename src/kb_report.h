@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * HID report layout derived from the enabled features
+ *
+ * Every report length here is a compile-time constant so endpoint and
+ * transfer buffers can be sized exactly. The devicetree in-report-size
+ * and out-report-size must match KB_IN_REPORT_SIZE and KB_OUT_REPORT_SIZE,
+ * kb_report.c fails the build otherwise.
+ */
+
+#ifndef KEYBOARD_KB_REPORT_H
+#define KEYBOARD_KB_REPORT_H
+
+#include "kb_state.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <zephyr/sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Report IDs are only used when more than one report is described */
+#define KB_REPORT_IDS (IS_ENABLED(CONFIG_KEYBOARD_CONSUMER) || \
+		       IS_ENABLED(CONFIG_KEYBOARD_VENDOR_REPORT))
+#define KB_REPORT_ID_SIZE (KB_REPORT_IDS ? 1 : 0)
+
+#define KB_REPORT_ID_KEYBOARD 1
+#define KB_REPORT_ID_CONSUMER 2
+#define KB_REPORT_ID_VENDOR 3
+
+/* Boot protocol keyboard report, never prefixed with an ID */
+#define KB_BOOT_REPORT_SIZE KB_REPORT_COUNT
+
+/* Report protocol keyboard report: modifiers plus bitmap or key array */
+#ifdef CONFIG_KEYBOARD_NKRO
+#define KB_KBD_REPORT_SIZE (KB_REPORT_ID_SIZE + 1 + KB_NKRO_BITMAP_SIZE)
+#else
+#define KB_KBD_REPORT_SIZE (KB_REPORT_ID_SIZE + KB_REPORT_COUNT)
+#endif
+
+/* Largest keyboard report in either protocol */
+#define KB_KBD_REPORT_MAX MAX(KB_KBD_REPORT_SIZE, KB_BOOT_REPORT_SIZE)
+
+/* Consumer control report: one 16-bit usage */
+#ifdef CONFIG_KEYBOARD_CONSUMER
+#define KB_CONSUMER_REPORT_SIZE (KB_REPORT_ID_SIZE + 2)
+#else
+#define KB_CONSUMER_REPORT_SIZE 0
+#endif
+
+/* Vendor-defined status report */
+#ifdef CONFIG_KEYBOARD_VENDOR_REPORT
+#define KB_VENDOR_REPORT_SIZE (KB_REPORT_ID_SIZE + CONFIG_KEYBOARD_VENDOR_REPORT_SIZE)
+#else
+#define KB_VENDOR_REPORT_SIZE 0
+#endif
+
+/* Largest input report, the interrupt IN endpoint size */
+#define KB_IN_REPORT_SIZE MAX(KB_KBD_REPORT_MAX, \
+			      MAX(KB_CONSUMER_REPORT_SIZE, KB_VENDOR_REPORT_SIZE))
+
+/* LED output report */
+#define KB_OUT_REPORT_SIZE (KB_REPORT_ID_SIZE + 1)
+
+/*
+ * Get the report descriptor for the enabled features.
+ *
+ * @param size Set to the descriptor size in bytes
+ * @return Pointer to the descriptor
+ */
+const uint8_t *kb_report_desc(size_t *size);
+
+/*
+ * Build the keyboard input report.
+ *
+ * @param state Key state
+ * @param boot True for the boot protocol layout
+ * @param buf Destination of at least KB_KBD_REPORT_MAX bytes
+ * @return Report length in bytes
+ */
+size_t kb_report_build_keyboard(const struct kb_state *state, bool boot, uint8_t *buf);
+
+#ifdef CONFIG_KEYBOARD_CONSUMER
+/*
+ * Build the consumer control input report.
+ *
+ * @param state Key state
+ * @param buf Destination of at least KB_CONSUMER_REPORT_SIZE bytes
+ * @return Report length in bytes
+ */
+size_t kb_report_build_consumer(const struct kb_state *state, uint8_t *buf);
+#endif
+
+#ifdef CONFIG_KEYBOARD_VENDOR_REPORT
+/* Device status carried by the vendor-defined report */
+struct kb_report_status {
+	uint8_t protocol;
+	/* enum kb_host_type */
+	uint8_t host;
+	uint32_t evt_dropped;
+	/* Effective host polling interval and missed polls */
+	uint16_t poll_us;
+	uint16_t poll_missed;
+	/* Input report submissions rejected as busy or failed */
+	uint16_t usb_busy;
+	uint16_t usb_errors;
+	/* KB_STATUS_POLL_* state of the last polling probe */
+	uint8_t poll_flags;
+};
+
+/* The probe is still measuring */
+#define KB_STATUS_POLL_RUNNING BIT(0)
+/* It ended on a submit error or the interface going down */
+#define KB_STATUS_POLL_ABORTED BIT(1)
+/* Fewer intervals than requested, poll_us and poll_missed are partial */
+#define KB_STATUS_POLL_PARTIAL BIT(2)
+
+/*
+ * Build the vendor-defined status report.
+ *
+ * @param status Device status
+ * @param buf Destination of at least KB_VENDOR_REPORT_SIZE bytes
+ * @return Report length in bytes
+ */
+size_t kb_report_build_vendor(const struct kb_report_status *status, uint8_t *buf);
+#endif
+
+/*
+ * Get the LED bitmap from an output report.
+ *
+ * @param boot True if the report uses the boot protocol layout
+ * @param len Report length in bytes
+ * @param buf Report data
+ * @return LED bitmap, or a negative errno if the report is too short
+ */
+int kb_report_parse_leds(bool boot, uint16_t len, const uint8_t *buf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KEYBOARD_KB_REPORT_H */
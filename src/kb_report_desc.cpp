@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * HID report descriptor for the enabled features
+ *
+ * The descriptor is built by the compiler with kb::hid::Descriptor, the
+ * same Kconfig conditions select its parts as select the report sizes in
+ * kb_report.h. The sizes the descriptor actually describes are checked
+ * against those macros below, so the report builders, the endpoint size
+ * and the descriptor can no longer drift apart. Only the final bytes end
+ * up in the image.
+ */
+
+#include "kb_hid_keys.hpp"
+
+#include "kb_report.h"
+
+#include <zephyr/sys/util.h>
+
+#ifdef CONFIG_KEYBOARD_GENERATED_KEYMAP
+#include "kb_keymap_generated.h"
+#define KB_KEY_USAGE_MAX KB_KEYMAP_MAX_USAGE
+#else
+/* Highest usage kb_input_to_hid() can return */
+#define KB_KEY_USAGE_MAX kb::hid::kInputKeyTable.max_usage
+#endif
+
+using namespace kb::hid;
+
+namespace {
+
+constexpr uint8_t kUsagePageGenericDesktop = 0x01;
+constexpr uint8_t kUsagePageKeyboard = 0x07;
+constexpr uint8_t kUsagePageLeds = 0x08;
+constexpr uint8_t kUsagePageConsumer = 0x0C;
+constexpr uint16_t kUsagePageVendor = 0xFF00;
+
+constexpr uint8_t kUsageKeyboard = 0x06;
+constexpr uint8_t kUsageConsumerControl = 0x01;
+constexpr uint16_t kConsumerUsageMax = 0x03FF;
+
+constexpr uint8_t kLeds = 5;
+
+/* Generous upper bound, trimmed to the real size below */
+using Builder = Descriptor<128>;
+
+constexpr Builder build()
+{
+	Builder d{};
+
+	d.usage_page(kUsagePageGenericDesktop)
+		.usage(kUsageKeyboard)
+		.collection(kCollectionApplication);
+	if (KB_REPORT_IDS) {
+		d.report_id(KB_REPORT_ID_KEYBOARD);
+	}
+
+	/* Modifier bitmap */
+	d.usage_page(kUsagePageKeyboard)
+		.usage_min(HID_KBD_USAGE_MODIFIER_FIRST)
+		.usage_max(HID_KBD_USAGE_MODIFIER_FIRST + 7)
+		.logical_min(0)
+		.logical_max(1)
+		.report_size(1)
+		.report_count(8)
+		.input(kData | kVar);
+
+	if (IS_ENABLED(CONFIG_KEYBOARD_NKRO)) {
+		/* One bit per key usage */
+		d.usage_min(0)
+			.usage_max(KB_NKRO_USAGE_MAX)
+			.report_count(KB_NKRO_USAGE_MAX + 1)
+			.input(kData | kVar);
+	} else {
+		/* Reserved byte, then the key array */
+		d.report_size(8)
+			.report_count(1)
+			.input(kConst | kVar)
+			.report_size(8)
+			.report_count(KB_MAX_PRESSED_KEYS)
+			.logical_min(0)
+			.logical_max(KB_KEY_USAGE_MAX)
+			.usage_min(0)
+			.usage_max(KB_KEY_USAGE_MAX)
+			.input(kData | kArray);
+	}
+
+	/* LEDs, padded to a byte */
+	d.usage_page(kUsagePageLeds)
+		.usage_min(1)
+		.usage_max(kLeds)
+		.logical_min(0)
+		.logical_max(1)
+		.report_size(1)
+		.report_count(kLeds)
+		.output(kData | kVar)
+		.report_size(8 - kLeds)
+		.report_count(1)
+		.output(kConst | kVar)
+		.end_collection();
+
+	if (IS_ENABLED(CONFIG_KEYBOARD_CONSUMER)) {
+		d.usage_page(kUsagePageConsumer)
+			.usage(kUsageConsumerControl)
+			.collection(kCollectionApplication)
+			.report_id(KB_REPORT_ID_CONSUMER)
+			.logical_min(0)
+			.logical_max(kConsumerUsageMax)
+			.usage_min(0)
+			.usage_max(kConsumerUsageMax)
+			.report_size(16)
+			.report_count(1)
+			.input(kData | kArray)
+			.end_collection();
+	}
+
+#ifdef CONFIG_KEYBOARD_VENDOR_REPORT
+	d.usage_page(kUsagePageVendor)
+		.usage(0x01)
+		.collection(kCollectionApplication)
+		.report_id(KB_REPORT_ID_VENDOR)
+		.usage(0x01)
+		.logical_min(0)
+		.logical_max(0xFF)
+		.report_size(8)
+		.report_count(CONFIG_KEYBOARD_VENDOR_REPORT_SIZE)
+		.input(kData | kVar)
+		.end_collection();
+#endif
+
+	return d;
+}
+
+constexpr Builder kBuilt = build();
+constexpr uint8_t kKeyboardId = KB_REPORT_IDS ? KB_REPORT_ID_KEYBOARD : 0;
+
+static_assert(kBuilt.valid(), "Malformed report descriptor");
+static_assert(kBuilt.uses_ids() == KB_REPORT_IDS, "KB_REPORT_IDS does not match the descriptor");
+static_assert(KB_KEY_USAGE_MAX <= 127, "Key usages must fit an 8-bit Logical Maximum");
+static_assert(!IS_ENABLED(CONFIG_KEYBOARD_NKRO) || KB_KEY_USAGE_MAX <= KB_NKRO_USAGE_MAX,
+	      "Key usages beyond the NKRO bitmap");
+
+static_assert(kBuilt.report_bytes(In, kKeyboardId) == KB_KBD_REPORT_SIZE,
+	      "KB_KBD_REPORT_SIZE does not match the descriptor");
+static_assert(kBuilt.report_bytes(Out, kKeyboardId) == KB_OUT_REPORT_SIZE,
+	      "KB_OUT_REPORT_SIZE does not match the descriptor");
+static_assert(!IS_ENABLED(CONFIG_KEYBOARD_CONSUMER) ||
+	      kBuilt.report_bytes(In, KB_REPORT_ID_CONSUMER) == KB_CONSUMER_REPORT_SIZE,
+	      "KB_CONSUMER_REPORT_SIZE does not match the descriptor");
+static_assert(!IS_ENABLED(CONFIG_KEYBOARD_VENDOR_REPORT) ||
+	      kBuilt.report_bytes(In, KB_REPORT_ID_VENDOR) == KB_VENDOR_REPORT_SIZE,
+	      "KB_VENDOR_REPORT_SIZE does not match the descriptor");
+/* Boot protocol reports are not in the descriptor but share the endpoint */
+static_assert(MAX(kBuilt.max_report_bytes(In), uint32_t{KB_BOOT_REPORT_SIZE}) == KB_IN_REPORT_SIZE,
+	      "KB_IN_REPORT_SIZE is not the largest input report");
+
+constexpr auto kDescriptor = kBuilt.trim<kBuilt.size()>();
+
+} /* namespace */
+
+extern "C" const uint8_t *kb_report_desc(size_t *size)
+{
+	*size = sizeof(kDescriptor.data);
+
+	return kDescriptor.data;
+}
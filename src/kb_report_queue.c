@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Pending input reports for a HID device
+ *
+ * The queue owns one UDC buffer for its transfer in flight. Submitting
+ * may take the UDC lock, so it happens outside the queue spinlock: the
+ * head is copied to the buffer and marked busy under the lock, and put
+ * back if the endpoint turns out to be busy with a report sent around
+ * the queue (idle re-send, polling probe). That transfer's completion
+ * then kicks the queue again.
+ *
+ * Each report keeps the stamp of the key event it reflects, a report
+ * superseded while full keeps the older one. When the host fetched the
+ * transfer the latency from detection is recorded.
+ */
+
+#include "kb_path.h"
+#include "kb_report_queue.h"
+#include "kb_usb_stats.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(kb_report_queue, CONFIG_KEYBOARD_LOG_LEVEL);
+
+#define QUEUE_DEPTH CONFIG_KEYBOARD_REPORT_QUEUE_DEPTH
+
+void kb_report_queue_init(struct kb_report_queue *queue, const struct device *dev,
+			  uint8_t *tx)
+{
+	memset(queue, 0, sizeof(*queue));
+	queue->dev = dev;
+	queue->tx = tx;
+}
+
+/* Submit the head if nothing is in flight */
+static int queue_kick(struct kb_report_queue *queue)
+{
+	k_spinlock_key_t key = k_spin_lock(&queue->lock);
+	struct kb_report_queue_entry *entry;
+	uint8_t len;
+	int ret;
+
+	if (queue->busy || queue->count == 0U) {
+		k_spin_unlock(&queue->lock, key);
+		return 0;
+	}
+
+	entry = &queue->entries[queue->head];
+	len = entry->len;
+	memcpy(queue->tx, entry->data, len);
+	queue->tx_stamp = entry->stamp;
+	queue->head = (queue->head + 1U) % QUEUE_DEPTH;
+	queue->count--;
+	queue->busy = true;
+	k_spin_unlock(&queue->lock, key);
+
+	ret = kb_usb_submit(queue->dev, len, queue->tx);
+	if (ret == 0) {
+		return 0;
+	}
+
+	key = k_spin_lock(&queue->lock);
+	queue->busy = false;
+
+	if (ret == -EBUSY) {
+		/*
+		 * Someone else's transfer is in flight, put the report back and
+		 * retry on its completion. Unless a put refilled the queue in
+		 * the meantime and reused the slot, then it is superseded.
+		 */
+		if (queue->count < QUEUE_DEPTH) {
+			queue->head = (queue->head + QUEUE_DEPTH - 1U) % QUEUE_DEPTH;
+			queue->count++;
+		} else {
+			queue->coalesced++;
+		}
+		k_spin_unlock(&queue->lock, key);
+		return 0;
+	}
+
+	/* Not configured or suspended, the state is resent on resume */
+	queue->dropped += queue->count + 1U;
+	queue->count = 0;
+	k_spin_unlock(&queue->lock, key);
+
+	return ret;
+}
+
+int kb_report_queue_put(struct kb_report_queue *queue, const uint8_t *report, size_t len,
+			uint32_t stamp)
+{
+	k_spinlock_key_t key;
+	struct kb_report_queue_entry *entry;
+
+	if (len > KB_IN_REPORT_SIZE) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&queue->lock);
+
+	if (queue->count == QUEUE_DEPTH) {
+		/* Full, the newest pending report is superseded */
+		entry = &queue->entries[(queue->head + queue->count - 1U) % QUEUE_DEPTH];
+		queue->coalesced++;
+	} else {
+		entry = &queue->entries[(queue->head + queue->count) % QUEUE_DEPTH];
+		entry->stamp = stamp;
+		queue->count++;
+		queue->high_water = MAX(queue->high_water, queue->count);
+	}
+
+	entry->len = len;
+	memcpy(entry->data, report, len);
+	k_spin_unlock(&queue->lock, key);
+
+	return queue_kick(queue);
+}
+
+void kb_report_queue_done(struct kb_report_queue *queue, const uint8_t *report)
+{
+	if (report == queue->tx) {
+		k_spinlock_key_t key = k_spin_lock(&queue->lock);
+
+		queue->busy = false;
+		k_spin_unlock(&queue->lock, key);
+
+		kb_path_record_delivered(queue->tx_stamp);
+	}
+
+	(void)queue_kick(queue);
+}
+
+void kb_report_queue_flush(struct kb_report_queue *queue)
+{
+	k_spinlock_key_t key = k_spin_lock(&queue->lock);
+
+	queue->count = 0;
+	queue->busy = false;
+	k_spin_unlock(&queue->lock, key);
+}
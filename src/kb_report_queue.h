@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Pending input reports for a HID device
+ */
+
+#ifndef KEYBOARD_KB_REPORT_QUEUE_H
+#define KEYBOARD_KB_REPORT_QUEUE_H
+
+#include "kb_report.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/device.h>
+#include <zephyr/spinlock.h>
+
+struct kb_report_queue_entry {
+	/* Stamp of the oldest key event in the report, see kb_stamp.h */
+	uint32_t stamp;
+	uint8_t len;
+	uint8_t data[KB_IN_REPORT_SIZE];
+};
+
+/*
+ * Reports waiting for the IN endpoint, oldest first. Every queued
+ * report reaches the host in order, so a press and release within one
+ * polling interval are both seen. When the queue is full the newest
+ * entry is replaced, the last state always gets through.
+ */
+struct kb_report_queue {
+	const struct device *dev;
+	/* UDC buffer of KB_IN_REPORT_SIZE bytes for the transfer in flight */
+	uint8_t *tx;
+	uint32_t tx_stamp;
+	struct k_spinlock lock;
+	struct kb_report_queue_entry entries[CONFIG_KEYBOARD_REPORT_QUEUE_DEPTH];
+	uint8_t head;
+	uint8_t count;
+	bool busy;
+	/* Reports replaced because the queue was full */
+	uint32_t coalesced;
+	/* Reports dropped after a submit error */
+	uint32_t dropped;
+	uint8_t high_water;
+};
+
+/*
+ * Initialize a queue.
+ *
+ * @param queue Queue to initialize
+ * @param dev HID device the reports are submitted to
+ * @param tx UDC buffer of at least KB_IN_REPORT_SIZE bytes
+ */
+void kb_report_queue_init(struct kb_report_queue *queue, const struct device *dev,
+			  uint8_t *tx);
+
+/*
+ * Queue a report and submit it if the endpoint is idle. Never blocks.
+ *
+ * @param queue Queue
+ * @param report Report data, copied
+ * @param len Report length, at most KB_IN_REPORT_SIZE
+ * @param stamp Stamp of the key event the report reflects
+ * @return 0 if submitted or queued, negative errno if the submit failed
+ */
+int kb_report_queue_put(struct kb_report_queue *queue, const uint8_t *report, size_t len,
+			uint32_t stamp);
+
+/*
+ * Submit the next pending report, from the input_report_done callback.
+ * Any completion on the device is a chance to submit, also the ones of
+ * reports sent around the queue.
+ *
+ * @param queue Queue
+ * @param report Buffer of the completed transfer
+ */
+void kb_report_queue_done(struct kb_report_queue *queue, const uint8_t *report);
+
+/*
+ * Drop every pending report, e.g. on a bus reset. Only call while the
+ * interface is disabled, no transfer can be in flight then.
+ *
+ * @param queue Queue
+ */
+void kb_report_queue_flush(struct kb_report_queue *queue);
+
+#endif /* KEYBOARD_KB_REPORT_QUEUE_H */
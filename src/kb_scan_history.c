@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * History of raw matrix scans for post-mortem analysis
+ *
+ * The matrix driver calls the column drive hook with
+ * INPUT_KBD_MATRIX_COLUMN_DRIVE_NONE at the end of every scan, when
+ * matrix_new_state holds the rows read from each column before
+ * debouncing. Scans that differ from the previous one are copied into
+ * a ring, a memcmp and a memcpy of a few words. Unchanged scans only
+ * cost the memcmp.
+ *
+ * The ring is frozen by "kb scan freeze", the SCAN_FREEZE key action,
+ * or when a scan shows two columns sharing two rows: the fourth corner
+ * of such a rectangle reads as pressed whether it is or not.
+ */
+
+#include "kb_scan_history.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(kb_scan_history, CONFIG_KEYBOARD_LOG_LEVEL);
+
+#define HISTORY_DEPTH CONFIG_KEYBOARD_SCAN_HISTORY_DEPTH
+
+static struct kb_scan_entry history[HISTORY_DEPTH];
+/* Scans recorded, the newest is at (head - 1) % HISTORY_DEPTH */
+static uint32_t history_head;
+static atomic_t history_frozen;
+static uint32_t history_frozen_at;
+
+static bool history_ghost(const kbd_row_t *rows, unsigned int cols)
+{
+	for (unsigned int a = 0; a < cols; a++) {
+		if ((rows[a] & (rows[a] - 1)) == 0) {
+			/* Fewer than two rows in this column */
+			continue;
+		}
+
+		for (unsigned int b = a + 1; b < cols; b++) {
+			kbd_row_t shared = rows[a] & rows[b];
+
+			if ((shared & (shared - 1)) != 0) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void input_kbd_matrix_drive_column_hook(const struct device *dev, int col)
+{
+	const struct input_kbd_matrix_common_config *cfg = dev->config;
+	unsigned int cols = MIN(cfg->col_size, KB_SCAN_HISTORY_COLS);
+	size_t size = cols * sizeof(kbd_row_t);
+	struct kb_scan_entry *entry;
+
+	if (col != INPUT_KBD_MATRIX_COLUMN_DRIVE_NONE || atomic_get(&history_frozen) != 0) {
+		return;
+	}
+
+	if (history_head != 0U &&
+	    memcmp(history[(history_head - 1U) % HISTORY_DEPTH].rows,
+		   cfg->matrix_new_state, size) == 0) {
+		return;
+	}
+
+	entry = &history[history_head % HISTORY_DEPTH];
+	entry->cycles = k_cycle_get_32();
+	memcpy(entry->rows, cfg->matrix_new_state, size);
+	history_head++;
+
+	if (IS_ENABLED(CONFIG_KEYBOARD_SCAN_HISTORY_GHOST_FREEZE) &&
+	    history_ghost(entry->rows, cols)) {
+		kb_scan_history_freeze(KB_SCAN_FROZEN_GHOST);
+	}
+}
+
+void kb_scan_history_freeze(enum kb_scan_freeze_reason reason)
+{
+	if (atomic_cas(&history_frozen, KB_SCAN_RUNNING, reason)) {
+		history_frozen_at = k_cycle_get_32();
+		LOG_WRN("Scan history frozen, %s", reason == KB_SCAN_FROZEN_GHOST ?
+			"ghost pattern" : "user request");
+	}
+}
+
+void kb_scan_history_resume(void)
+{
+	/* The writer is idle while frozen, clear before letting it run */
+	history_head = 0;
+	atomic_set(&history_frozen, KB_SCAN_RUNNING);
+}
+
+int kb_scan_history_get(unsigned int age, struct kb_scan_entry *entry)
+{
+	/* The oldest slot may have been overwritten while freezing */
+	uint32_t count = MIN(history_head, HISTORY_DEPTH - 1U);
+
+	if (age >= count) {
+		return -ENOENT;
+	}
+
+	*entry = history[(history_head - 1U - age) % HISTORY_DEPTH];
+
+	return 0;
+}
+
+enum kb_scan_freeze_reason kb_scan_history_state(uint32_t *cycles)
+{
+	if (cycles != NULL) {
+		*cycles = history_frozen_at;
+	}
+
+	return atomic_get(&history_frozen);
+}
+
+#ifdef CONFIG_KEYBOARD_SHELL
+static int cmd_scan_freeze(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	kb_scan_history_freeze(KB_SCAN_FROZEN_USER);
+
+	return 0;
+}
+
+static int cmd_scan_resume(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	kb_scan_history_resume();
+
+	return 0;
+}
+
+static int cmd_scan_dump(const struct shell *sh, size_t argc, char **argv)
+{
+	static const char *const reasons[] = {
+		[KB_SCAN_RUNNING] = "running",
+		[KB_SCAN_FROZEN_USER] = "frozen by user",
+		[KB_SCAN_FROZEN_GHOST] = "frozen on ghost pattern",
+	};
+	struct kb_scan_entry entry;
+	enum kb_scan_freeze_reason reason;
+	uint32_t frozen_at;
+	char line[KB_SCAN_HISTORY_COLS * (2 * sizeof(kbd_row_t) + 1) + 1];
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	reason = kb_scan_history_state(&frozen_at);
+	if (reason == KB_SCAN_RUNNING) {
+		shell_error(sh, "Freeze the history first");
+		return -EBUSY;
+	}
+
+	shell_print(sh, "%s, rows of columns 0..%u, newest last", reasons[reason],
+		    KB_SCAN_HISTORY_COLS - 1);
+
+	for (int age = HISTORY_DEPTH - 1; age >= 0; age--) {
+		size_t n = 0;
+
+		if (kb_scan_history_get(age, &entry) != 0) {
+			continue;
+		}
+
+		for (unsigned int c = 0; c < KB_SCAN_HISTORY_COLS; c++) {
+			n += snprintk(&line[n], sizeof(line) - n, "%0*x ",
+				      (int)(2 * sizeof(kbd_row_t)), entry.rows[c]);
+		}
+
+		shell_print(sh, "%10u us  %s",
+			    k_cyc_to_us_floor32(frozen_at - entry.cycles), line);
+	}
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_scan,
+	SHELL_CMD(freeze, NULL, "Stop recording raw scans", cmd_scan_freeze),
+	SHELL_CMD(resume, NULL, "Discard the history and record again", cmd_scan_resume),
+	SHELL_CMD(dump, NULL, "Print the frozen history, age before the freeze",
+		  cmd_scan_dump),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_SUBCMD_ADD((kb), scan, &sub_scan, "Raw matrix scan history", NULL, 1, 0);
+#endif /* CONFIG_KEYBOARD_SHELL */
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * History of raw matrix scans for post-mortem analysis
+ */
+
+#ifndef KEYBOARD_KB_SCAN_HISTORY_H
+#define KEYBOARD_KB_SCAN_HISTORY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/devicetree.h>
+#include <zephyr/input/input_kbd_matrix.h>
+
+enum kb_scan_freeze_reason {
+	KB_SCAN_RUNNING,
+	/* Shell command or key action */
+	KB_SCAN_FROZEN_USER,
+	/* Two columns shared two rows, a possible ghost key */
+	KB_SCAN_FROZEN_GHOST,
+};
+
+/*
+ * Stop recording, the history keeps the scans leading up to now.
+ *
+ * @param reason Why the history is frozen
+ */
+void kb_scan_history_freeze(enum kb_scan_freeze_reason reason);
+
+/* Discard the history and record again */
+void kb_scan_history_resume(void);
+
+#if DT_HAS_COMPAT_STATUS_OKAY(gpio_kbd_matrix)
+#define KB_SCAN_HISTORY_COLS \
+	DT_PROP_LEN(DT_COMPAT_GET_ANY_STATUS_OKAY(gpio_kbd_matrix), col_gpios)
+
+/* One raw scan, before debouncing */
+struct kb_scan_entry {
+	/* k_cycle_get_32() at the end of the scan */
+	uint32_t cycles;
+	kbd_row_t rows[KB_SCAN_HISTORY_COLS];
+};
+
+/*
+ * Get a recorded scan. Only consistent while frozen.
+ *
+ * @param age 0 for the newest scan, 1 for the one before it and so on
+ * @param entry Set to the scan
+ * @return 0 on success, -ENOENT if there is no such scan
+ */
+int kb_scan_history_get(unsigned int age, struct kb_scan_entry *entry);
+#endif
+
+/*
+ * Get the freeze state.
+ *
+ * @param cycles If not NULL, set to k_cycle_get_32() at the freeze
+ * @return Freeze reason, KB_SCAN_RUNNING if recording
+ */
+enum kb_scan_freeze_reason kb_scan_history_state(uint32_t *cycles);
+
+#endif /* KEYBOARD_KB_SCAN_HISTORY_H */
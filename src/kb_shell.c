@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Root of the "kb" shell command, extended by the other modules
+ */
+
+#include <zephyr/shell/shell.h>
+
+SHELL_SUBCMD_SET_CREATE(kb_cmds, (kb));
+SHELL_CMD_REGISTER(kb, &kb_cmds, "Keyboard commands", NULL);
+
+/* "kb usb" diagnostics, extended by the USB modules */
+SHELL_SUBCMD_SET_CREATE(kb_usb_cmds, (kb, usb));
+SHELL_SUBCMD_ADD((kb), usb, &kb_usb_cmds, "USB transfer diagnostics", NULL, 1, 0);
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Scripted typing workload for the simulated keyboard
+ *
+ * Injects key events through the input subsystem, the same path the
+ * matrix scanner uses, and prints every injection with its uptime so a
+ * host-side consumer can match reports and compute latency and loss.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/input/input.h>
+#include <zephyr/sys/printk.h>
+
+/* "the quick brown fox jumps over the lazy dog" */
+static const uint16_t sim_script[] = {
+	INPUT_KEY_T, INPUT_KEY_H, INPUT_KEY_E, INPUT_KEY_SPACE,
+	INPUT_KEY_Q, INPUT_KEY_U, INPUT_KEY_I, INPUT_KEY_C, INPUT_KEY_K,
+	INPUT_KEY_SPACE,
+	INPUT_KEY_B, INPUT_KEY_R, INPUT_KEY_O, INPUT_KEY_W, INPUT_KEY_N,
+	INPUT_KEY_SPACE,
+	INPUT_KEY_F, INPUT_KEY_O, INPUT_KEY_X, INPUT_KEY_SPACE,
+	INPUT_KEY_J, INPUT_KEY_U, INPUT_KEY_M, INPUT_KEY_P, INPUT_KEY_S,
+	INPUT_KEY_SPACE,
+	INPUT_KEY_O, INPUT_KEY_V, INPUT_KEY_E, INPUT_KEY_R, INPUT_KEY_SPACE,
+	INPUT_KEY_T, INPUT_KEY_H, INPUT_KEY_E, INPUT_KEY_SPACE,
+	INPUT_KEY_L, INPUT_KEY_A, INPUT_KEY_Z, INPUT_KEY_Y, INPUT_KEY_SPACE,
+	INPUT_KEY_D, INPUT_KEY_O, INPUT_KEY_G, INPUT_KEY_ENTER,
+};
+
+static uint32_t sim_seq;
+
+static void sim_inject(uint16_t code, int32_t value)
+{
+	uint64_t now_us = k_ticks_to_us_floor64(k_uptime_ticks());
+
+	printk("kb_sim: inject %u %u %d %llu\n", sim_seq++, code, value, now_us);
+	input_report_key(NULL, code, value, true, K_FOREVER);
+}
+
+static void sim_typing_thread(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (int n = 0; n < CONFIG_KEYBOARD_SIM_TYPING_REPEAT; n++) {
+		for (size_t i = 0; i < ARRAY_SIZE(sim_script); i++) {
+			sim_inject(sim_script[i], 1);
+			k_msleep(CONFIG_KEYBOARD_SIM_TYPING_HOLD_MS);
+			sim_inject(sim_script[i], 0);
+			k_msleep(CONFIG_KEYBOARD_SIM_TYPING_GAP_MS);
+		}
+	}
+
+	printk("kb_sim: done %u\n", sim_seq);
+}
+
+K_THREAD_DEFINE(kb_sim_typing, 1024, sim_typing_thread, NULL, NULL, NULL,
+		K_LOWEST_APPLICATION_THREAD_PRIO, 0,
+		CONFIG_KEYBOARD_SIM_TYPING_START_DELAY_MS);
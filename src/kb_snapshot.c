@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Double-buffered snapshot of the current keyboard report
+ *
+ * The writer fills the slot readers are not pointed at and then flips
+ * the index, so the published slot is always complete. Readers copy it
+ * once, without a retry loop: neither side ever waits on the other.
+ * A slot is only rewritten by the second publish after the one that
+ * filled it. The readers run cooperatively on this single core, so the
+ * preemptible writer cannot run twice while one of them copies.
+ */
+
+#include "kb_snapshot.h"
+
+#include <string.h>
+
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/barrier.h>
+#include <zephyr/sys/util.h>
+
+struct snapshot_slot {
+	uint32_t seq;
+	size_t len;
+	uint8_t data[KB_KBD_REPORT_MAX];
+};
+
+static struct snapshot_slot snapshot_slots[2];
+/* Index of the last complete slot */
+static atomic_t snapshot_idx;
+
+void kb_snapshot_publish(const uint8_t *report, size_t len)
+{
+	atomic_val_t idx = atomic_get(&snapshot_idx);
+	struct snapshot_slot *slot = &snapshot_slots[idx ^ 1];
+
+	memcpy(slot->data, report, len);
+	slot->len = len;
+	slot->seq = snapshot_slots[idx].seq + 1U;
+
+	barrier_dmem_fence_full();
+	atomic_set(&snapshot_idx, idx ^ 1);
+}
+
+uint32_t kb_snapshot_read(uint8_t *report, size_t *len)
+{
+	const struct snapshot_slot *slot = &snapshot_slots[atomic_get(&snapshot_idx)];
+
+	barrier_dmem_fence_full();
+
+	*len = MIN(slot->len, sizeof(slot->data));
+	memcpy(report, slot->data, *len);
+
+	return slot->seq;
+}
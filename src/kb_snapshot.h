@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Double-buffered snapshot of the current keyboard report
+ */
+
+#ifndef KEYBOARD_KB_SNAPSHOT_H
+#define KEYBOARD_KB_SNAPSHOT_H
+
+#include "kb_report.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Publish a new report. Wait-free, must only be called from the single
+ * writer (the key event consumer).
+ *
+ * @param report Keyboard report to publish
+ * @param len Report length, at most KB_KBD_REPORT_MAX bytes
+ */
+void kb_snapshot_publish(const uint8_t *report, size_t len);
+
+/*
+ * Copy the last complete report, never waits. Only call from
+ * cooperative threads or callbacks running in them, which the writer
+ * cannot preempt; not from an ISR.
+ *
+ * @param report Destination buffer of KB_KBD_REPORT_MAX bytes
+ * @param len Set to the report length
+ * @return Sequence number of the copied report, increasing by 1 per publish
+ */
+uint32_t kb_snapshot_read(uint8_t *report, size_t *len);
+
+#endif /* KEYBOARD_KB_SNAPSHOT_H */
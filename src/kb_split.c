@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * NKRO split across several boot keyboard interfaces
+ *
+ * Boot-only hosts (BIOS, KVM switches) parse at most six keys per
+ * keyboard but merge several keyboards. Every interface gets six key
+ * slots: newly pressed keys take the first free slot in ascending usage
+ * order, released keys free theirs. The modifiers travel on the primary
+ * interface, so KB_SPLIT_COUNT interfaces deliver 6 * KB_SPLIT_COUNT keys.
+ *
+ * Each secondary interface has its own report queue, like the primary
+ * one, so a change made while its previous report is in flight is sent
+ * on completion instead of lost.
+ */
+
+#include "kb_report.h"
+#include "kb_report_queue.h"
+#include "kb_split.h"
+#include "kb_stamp.h"
+#include "kb_usb_stats.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/usb/udc_buf.h>
+#include <zephyr/usb/class/usbd_hid.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(kb_split, CONFIG_KEYBOARD_LOG_LEVEL);
+
+#define SPLIT_DEV(node_id) DEVICE_DT_GET(node_id),
+
+static const struct device *const split_all_devs[] = {
+	DT_FOREACH_STATUS_OKAY(zephyr_hid_device, SPLIT_DEV)
+};
+
+BUILD_ASSERT(ARRAY_SIZE(split_all_devs) == KB_SPLIT_COUNT,
+	     "Define one zephyr,hid-device node per split interface");
+
+/* Secondary transfer buffers, one granule each for the UDC */
+#define SPLIT_STRIDE ROUND_UP(KB_IN_REPORT_SIZE, UDC_BUF_GRANULARITY)
+
+UDC_STATIC_BUF_DEFINE(split_bufs, SPLIT_STRIDE * (KB_SPLIT_COUNT - 1));
+
+struct split_iface {
+	const struct device *dev;
+	struct kb_report_queue queue;
+	bool ready;
+};
+
+static struct split_iface split_ifaces[KB_SPLIT_COUNT - 1];
+static uint8_t split_slots[KB_SPLIT_COUNT][KB_MAX_PRESSED_KEYS];
+static uint8_t split_last[KB_SPLIT_COUNT][KB_REPORT_COUNT];
+static struct k_spinlock split_lock;
+
+static struct split_iface *split_iface_get(const struct device *dev)
+{
+	for (unsigned int i = 0; i < ARRAY_SIZE(split_ifaces); i++) {
+		if (split_ifaces[i].dev == dev) {
+			return &split_ifaces[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void split_submit(struct split_iface *iface, const uint8_t *report, uint32_t stamp)
+{
+	int ret;
+
+	if (iface->dev == NULL || !iface->ready) {
+		return;
+	}
+
+	/* Queued behind a transfer in flight, the report is copied */
+	ret = kb_report_queue_put(&iface->queue, report, KB_REPORT_COUNT, stamp);
+	if (ret != 0) {
+		LOG_ERR("Split interface %s submit error, %d", iface->dev->name, ret);
+	}
+}
+
+static void split_iface_ready(const struct device *dev, const bool ready)
+{
+	struct split_iface *iface = split_iface_get(dev);
+	k_spinlock_key_t key;
+	uint8_t last[KB_REPORT_COUNT];
+
+	LOG_INF("Split interface %s is %s", dev->name, ready ? "ready" : "not ready");
+	if (iface == NULL) {
+		return;
+	}
+
+	iface->ready = ready;
+	if (!ready) {
+		kb_report_queue_flush(&iface->queue);
+		return;
+	}
+
+	/* The host forgot the keys held on this interface, resend them */
+	key = k_spin_lock(&split_lock);
+	memcpy(last, split_last[iface - split_ifaces + 1], KB_REPORT_COUNT);
+	k_spin_unlock(&split_lock, key);
+
+	split_submit(iface, last, kb_stamp());
+}
+
+static int split_get_report(const struct device *dev,
+			    const uint8_t type, const uint8_t id, const uint16_t len,
+			    uint8_t *const buf)
+{
+	struct split_iface *iface = split_iface_get(dev);
+	k_spinlock_key_t key;
+
+	if (iface == NULL || type != HID_REPORT_TYPE_INPUT || len < KB_REPORT_COUNT) {
+		return 0;
+	}
+
+	/* Called from the USB stack, the event consumer updates split_last */
+	key = k_spin_lock(&split_lock);
+	memcpy(buf, split_last[iface - split_ifaces + 1], KB_REPORT_COUNT);
+	k_spin_unlock(&split_lock, key);
+
+	return KB_REPORT_COUNT;
+}
+
+static int split_set_report(const struct device *dev,
+			    const uint8_t type, const uint8_t id, const uint16_t len,
+			    const uint8_t *const buf)
+{
+	/* LED reports are only honoured on the primary interface */
+	return 0;
+}
+
+static void split_input_report_done(const struct device *dev,
+				    const uint8_t *const report)
+{
+	struct split_iface *iface = split_iface_get(dev);
+
+	kb_usb_report_done(dev);
+
+	if (iface != NULL) {
+		kb_report_queue_done(&iface->queue, report);
+	}
+}
+
+static const struct hid_device_ops split_ops = {
+	.iface_ready = split_iface_ready,
+	.input_report_done = split_input_report_done,
+	.get_report = split_get_report,
+	.set_report = split_set_report,
+};
+
+int kb_split_init(const struct device *primary)
+{
+	const uint8_t *desc;
+	size_t desc_size;
+	unsigned int n = 0;
+	int ret;
+
+	desc = kb_report_desc(&desc_size);
+
+	for (unsigned int i = 0; i < ARRAY_SIZE(split_all_devs); i++) {
+		const struct device *dev = split_all_devs[i];
+
+		if (dev == primary) {
+			continue;
+		}
+
+		if (n == ARRAY_SIZE(split_ifaces) || !device_is_ready(dev)) {
+			LOG_ERR("Split interface %s is not usable", dev->name);
+			return -ENODEV;
+		}
+
+		split_ifaces[n].dev = dev;
+		kb_report_queue_init(&split_ifaces[n].queue, dev, &split_bufs[n * SPLIT_STRIDE]);
+
+		ret = hid_device_register(dev, desc, desc_size, &split_ops);
+		if (ret != 0) {
+			LOG_ERR("Failed to register split interface %s, %d", dev->name, ret);
+			return ret;
+		}
+
+		n++;
+	}
+
+	LOG_INF("Keys split over %u boot interfaces", n + 1);
+
+	return 0;
+}
+
+/* Free the slots of released keys and mark the ones still assigned */
+static void split_release(const struct kb_state *state, uint8_t *assigned)
+{
+	for (unsigned int i = 0; i < KB_SPLIT_COUNT; i++) {
+		for (unsigned int s = 0; s < KB_MAX_PRESSED_KEYS; s++) {
+			uint8_t usage = split_slots[i][s];
+
+			if (usage == 0) {
+				continue;
+			}
+
+			if ((state->key_bitmap[usage / 8] & BIT(usage % 8)) == 0) {
+				split_slots[i][s] = 0;
+			} else {
+				assigned[usage / 8] |= BIT(usage % 8);
+			}
+		}
+	}
+}
+
+static bool split_assign(uint8_t usage)
+{
+	for (unsigned int i = 0; i < KB_SPLIT_COUNT; i++) {
+		for (unsigned int s = 0; s < KB_MAX_PRESSED_KEYS; s++) {
+			if (split_slots[i][s] == 0) {
+				split_slots[i][s] = usage;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+static void split_build(unsigned int iface, uint8_t modifiers, uint8_t *report)
+{
+	unsigned int n = 0;
+
+	memset(report, 0, KB_REPORT_COUNT);
+	report[KB_MOD_KEY] = modifiers;
+
+	/* Pack the slots, a hole would read as an empty key */
+	for (unsigned int s = 0; s < KB_MAX_PRESSED_KEYS; s++) {
+		if (split_slots[iface][s] != 0) {
+			report[KB_KEY_CODE1 + n++] = split_slots[iface][s];
+		}
+	}
+}
+
+bool kb_split_update(const struct kb_state *state, uint8_t *report, uint32_t stamp)
+{
+	uint8_t assigned[KB_NKRO_BITMAP_SIZE] = {0};
+	uint8_t next[KB_REPORT_COUNT];
+	bool changed = false;
+
+	split_release(state, assigned);
+
+	/* Usage 0 is "no event", never a key */
+	for (unsigned int b = 0; b < KB_NKRO_BITMAP_SIZE; b++) {
+		uint8_t fresh = state->key_bitmap[b] & ~assigned[b];
+
+		while (fresh != 0) {
+			unsigned int bit = find_lsb_set(fresh) - 1;
+			uint8_t usage = b * 8 + bit;
+
+			fresh &= ~BIT(bit);
+			if (usage != 0 && !split_assign(usage)) {
+				LOG_DBG("All %u split slots in use", KB_SPLIT_COUNT * KB_MAX_PRESSED_KEYS);
+			}
+		}
+	}
+
+	for (unsigned int i = 0; i < KB_SPLIT_COUNT; i++) {
+		k_spinlock_key_t key;
+
+		split_build(i, i == 0 ? state->modifiers : 0, next);
+		if (memcmp(next, split_last[i], KB_REPORT_COUNT) == 0) {
+			continue;
+		}
+
+		key = k_spin_lock(&split_lock);
+		memcpy(split_last[i], next, KB_REPORT_COUNT);
+		k_spin_unlock(&split_lock, key);
+
+		if (i == 0) {
+			changed = true;
+		} else {
+			split_submit(&split_ifaces[i - 1], next, stamp);
+		}
+	}
+
+	memcpy(report, split_last[0], KB_REPORT_COUNT);
+
+	return changed;
+}
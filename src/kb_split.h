@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * NKRO split across several boot keyboard interfaces
+ */
+
+#ifndef KEYBOARD_KB_SPLIT_H
+#define KEYBOARD_KB_SPLIT_H
+
+#include "kb_state.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/device.h>
+
+#define KB_SPLIT_COUNT CONFIG_KEYBOARD_SPLIT_BOOT_COUNT
+
+/*
+ * Register the secondary boot keyboard interfaces, every HID device
+ * except the primary one. Must be called before the USB device is
+ * initialized.
+ *
+ * @param primary HID device handled by the main loop
+ * @return 0 on success, negative errno otherwise
+ */
+int kb_split_init(const struct device *primary);
+
+/*
+ * Distribute the pressed keys over the interfaces and submit the
+ * secondary reports that changed. Keys keep their slot until released,
+ * so a key never moves between interfaces while held.
+ *
+ * @param state Key state with the key bitmap
+ * @param report Set to the primary interface boot report
+ * @param stamp Stamp of the key event, see kb_stamp.h
+ * @return True if the primary interface report changed
+ */
+bool kb_split_update(const struct kb_state *state, uint8_t *report, uint32_t stamp);
+
+#endif /* KEYBOARD_KB_SPLIT_H */
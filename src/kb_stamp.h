@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Key event timestamps
+ *
+ * A stamp is the free-running hardware cycle counter when the source of
+ * a key event first saw the change, before debouncing. Sources that
+ * know it report it with kb_stamp_report() right before the key event,
+ * for the others the input callback stamps the event on arrival. The
+ * stamp then travels with the event through the queue into the report
+ * queue, so latencies are measured from detection and time-based key
+ * decisions use the time the key actually moved.
+ *
+ * The counter wraps after 2^32 cycles, seconds at the usual clock
+ * rates, so stamps are only compared with recent ones.
+ */
+
+#ifndef KEYBOARD_KB_STAMP_H
+#define KEYBOARD_KB_STAMP_H
+
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/input/input.h>
+
+/* Input event carrying the stamp of the next key event of its device */
+#define KB_INPUT_EV_STAMP INPUT_EV_VENDOR_START
+
+static inline uint32_t kb_stamp(void)
+{
+	return k_cycle_get_32();
+}
+
+/* k_uptime_get_32() at the time of a recent stamp */
+static inline uint32_t kb_stamp_uptime_ms(uint32_t stamp)
+{
+	return k_uptime_get_32() - k_cyc_to_ms_floor32(kb_stamp() - stamp);
+}
+
+/*
+ * Report when the change of the next key event was detected.
+ *
+ * @param dev Input device reporting the key event
+ * @param stamp kb_stamp() at the detection
+ */
+static inline void kb_stamp_report(const struct device *dev, uint32_t stamp)
+{
+	(void)input_report(dev, KB_INPUT_EV_STAMP, 0, (int32_t)stamp, false, K_FOREVER);
+}
+
+#endif /* KEYBOARD_KB_STAMP_H */
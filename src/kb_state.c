@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Keyboard key state tracking and HID report building
+ */
+
+#include "kb_state.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/input/input.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/usb/class/hid.h>
+
+uint8_t kb_modifier_bit(uint16_t input_code)
+{
+	switch (input_code) {
+	case INPUT_KEY_LEFTCTRL:
+		return HID_KBD_MODIFIER_LEFT_CTRL;
+	case INPUT_KEY_LEFTSHIFT:
+		return HID_KBD_MODIFIER_LEFT_SHIFT;
+	case INPUT_KEY_LEFTALT:
+		return HID_KBD_MODIFIER_LEFT_ALT;
+	case INPUT_KEY_LEFTMETA:
+		return HID_KBD_MODIFIER_LEFT_UI;
+	case INPUT_KEY_RIGHTCTRL:
+		return HID_KBD_MODIFIER_RIGHT_CTRL;
+	case INPUT_KEY_RIGHTSHIFT:
+		return HID_KBD_MODIFIER_RIGHT_SHIFT;
+	case INPUT_KEY_RIGHTALT:
+		return HID_KBD_MODIFIER_RIGHT_ALT;
+	case INPUT_KEY_RIGHTMETA:
+		return HID_KBD_MODIFIER_RIGHT_UI;
+	default:
+		return 0;
+	}
+}
+
+uint16_t kb_input_to_consumer(uint16_t input_code)
+{
+	switch (input_code) {
+	case INPUT_KEY_MUTE:
+		return 0x00E2;
+	case INPUT_KEY_VOLUMEUP:
+		return 0x00E9;
+	case INPUT_KEY_VOLUMEDOWN:
+		return 0x00EA;
+	case INPUT_KEY_PLAYPAUSE:
+		return 0x00CD;
+	case INPUT_KEY_STOPCD:
+		return 0x00B7;
+	case INPUT_KEY_NEXTSONG:
+		return 0x00B5;
+	case INPUT_KEY_PREVIOUSSONG:
+		return 0x00B6;
+	default:
+		return 0;
+	}
+}
+
+void kb_state_reset(struct kb_state *state)
+{
+	memset(state, 0, sizeof(*state));
+}
+
+int kb_state_press(struct kb_state *state, uint8_t hid_key)
+{
+#ifdef CONFIG_KEYBOARD_KEY_BITMAP
+	if (hid_key <= KB_NKRO_USAGE_MAX) {
+		state->key_bitmap[hid_key / 8] |= BIT(hid_key % 8);
+	}
+#endif
+
+	/* Check if already pressed */
+	for (int i = 0; i < state->pressed_count; i++) {
+		if (state->pressed_keys[i] == hid_key) {
+			return 0;
+		}
+	}
+
+	/* Add if room available */
+	if (state->pressed_count < KB_MAX_PRESSED_KEYS) {
+		state->pressed_keys[state->pressed_count++] = hid_key;
+		return 0;
+	}
+
+	return -ENOSPC;
+}
+
+void kb_state_release(struct kb_state *state, uint8_t hid_key)
+{
+#ifdef CONFIG_KEYBOARD_KEY_BITMAP
+	if (hid_key <= KB_NKRO_USAGE_MAX) {
+		state->key_bitmap[hid_key / 8] &= ~BIT(hid_key % 8);
+	}
+#endif
+
+	for (int i = 0; i < state->pressed_count; i++) {
+		if (state->pressed_keys[i] == hid_key) {
+			/* Shift remaining keys */
+			for (int j = i; j < state->pressed_count - 1; j++) {
+				state->pressed_keys[j] = state->pressed_keys[j + 1];
+			}
+			state->pressed_count--;
+			return;
+		}
+	}
+}
+
+int kb_state_process_hid(struct kb_state *state, uint8_t usage, bool pressed)
+{
+	if (IN_RANGE(usage, HID_KBD_USAGE_MODIFIER_FIRST,
+		     HID_KBD_USAGE_MODIFIER_FIRST + 7)) {
+		uint8_t mod_bit = BIT(usage - HID_KBD_USAGE_MODIFIER_FIRST);
+
+		if (pressed) {
+			state->modifiers |= mod_bit;
+		} else {
+			state->modifiers &= ~mod_bit;
+		}
+		return 0;
+	}
+
+	if (pressed) {
+		return kb_state_press(state, usage);
+	}
+
+	kb_state_release(state, usage);
+	return 0;
+}
+
+int kb_state_process(struct kb_state *state, uint16_t input_code, bool pressed)
+{
+	uint8_t mod_bit = kb_modifier_bit(input_code);
+	uint8_t hid_key;
+
+	if (mod_bit != 0) {
+		/* Handle modifier keys */
+		if (pressed) {
+			state->modifiers |= mod_bit;
+		} else {
+			state->modifiers &= ~mod_bit;
+		}
+		return 0;
+	}
+
+#ifdef CONFIG_KEYBOARD_CONSUMER
+	uint16_t consumer = kb_input_to_consumer(input_code);
+
+	if (consumer != 0) {
+		/* One media key at a time, the last one pressed wins */
+		if (pressed) {
+			state->consumer = consumer;
+		} else if (state->consumer == consumer) {
+			state->consumer = 0;
+		}
+		return KB_STATE_CONSUMER_CHANGED;
+	}
+#endif
+
+	/* Handle regular keys */
+	hid_key = kb_input_to_hid(input_code);
+	if (hid_key == 0) {
+		return -ENOENT;
+	}
+
+	if (pressed) {
+		return kb_state_press(state, hid_key);
+	}
+
+	kb_state_release(state, hid_key);
+	return 0;
+}
+
+void kb_state_build_report(const struct kb_state *state, uint8_t *report)
+{
+	memset(report, 0, KB_REPORT_COUNT);
+
+	report[KB_MOD_KEY] = state->modifiers;
+	report[KB_RESERVED] = 0;
+
+	for (int i = 0; i < state->pressed_count && i < KB_MAX_PRESSED_KEYS; i++) {
+		report[KB_KEY_CODE1 + i] = state->pressed_keys[i];
+	}
+}
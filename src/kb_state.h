@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Keyboard key state tracking and HID report building
+ */
+
+#ifndef KEYBOARD_KB_STATE_H
+#define KEYBOARD_KB_STATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* HID keyboard report structure (8 bytes for boot protocol) */
+enum kb_report_idx {
+	KB_MOD_KEY = 0,
+	KB_RESERVED,
+	KB_KEY_CODE1,
+	KB_KEY_CODE2,
+	KB_KEY_CODE3,
+	KB_KEY_CODE4,
+	KB_KEY_CODE5,
+	KB_KEY_CODE6,
+	KB_REPORT_COUNT,
+};
+
+#define KB_MAX_PRESSED_KEYS 6
+
+/* Left Control, the first of the eight modifier usages */
+#define HID_KBD_USAGE_MODIFIER_FIRST 0xE0
+
+/* Key bitmap covers usages 0 to KB_NKRO_USAGE_MAX */
+#define KB_NKRO_USAGE_MAX 0x7F
+#define KB_NKRO_BITMAP_SIZE ((KB_NKRO_USAGE_MAX + 1) / 8)
+
+/* kb_state_process() result when only the consumer usage changed */
+#define KB_STATE_CONSUMER_CHANGED 1
+
+/*
+ * Current key state: modifier bitmap plus the regular keys in the
+ * order they were pressed (up to 6 for 6KRO), and with NKRO or split
+ * boot interfaces a bitmap of every pressed key.
+ */
+struct kb_state {
+	uint8_t pressed_keys[KB_MAX_PRESSED_KEYS];
+	uint8_t pressed_count;
+	uint8_t modifiers;
+#ifdef CONFIG_KEYBOARD_KEY_BITMAP
+	uint8_t key_bitmap[KB_NKRO_BITMAP_SIZE];
+#endif
+#ifdef CONFIG_KEYBOARD_CONSUMER
+	/* Consumer page usage, 0 if none is pressed */
+	uint16_t consumer;
+#endif
+};
+
+/*
+ * Clear all pressed keys and modifiers.
+ *
+ * @param state Key state to reset
+ */
+void kb_state_reset(struct kb_state *state);
+
+/*
+ * Convert an INPUT_KEY code to a HID key code.
+ *
+ * @param input_code INPUT_KEY_* value
+ * @return HID_KEY_* value, or 0 if not mappable (modifiers return 0)
+ */
+uint8_t kb_input_to_hid(uint16_t input_code);
+
+/*
+ * Get the HID modifier bit for an INPUT_KEY code.
+ *
+ * @param input_code INPUT_KEY_* value
+ * @return HID_KBD_MODIFIER_* bit, or 0 if not a modifier
+ */
+uint8_t kb_modifier_bit(uint16_t input_code);
+
+/*
+ * Get the consumer page usage for an INPUT_KEY code.
+ *
+ * @param input_code INPUT_KEY_* value
+ * @return Consumer usage, or 0 if the code is not a media key
+ */
+uint16_t kb_input_to_consumer(uint16_t input_code);
+
+/*
+ * Add a HID key to the pressed keys.
+ *
+ * With the key bitmap enabled the key is always recorded there, the
+ * 6KRO list then only feeds single boot protocol reports.
+ *
+ * @param state Key state to update
+ * @param hid_key HID_KEY_* value
+ * @return 0 if added or already present, -ENOSPC if the 6KRO limit is reached
+ */
+int kb_state_press(struct kb_state *state, uint8_t hid_key);
+
+/*
+ * Remove a HID key from the pressed keys, keeping the order of the rest.
+ *
+ * @param state Key state to update
+ * @param hid_key HID_KEY_* value
+ */
+void kb_state_release(struct kb_state *state, uint8_t hid_key);
+
+/*
+ * Apply a HID usage event to the key state.
+ *
+ * @param state Key state to update
+ * @param usage HID_KEY_* value, or a modifier usage (0xE0 to 0xE7)
+ * @param pressed True on press, false on release
+ * @return 0 on success, -ENOSPC if the 6KRO limit is reached
+ */
+int kb_state_process_hid(struct kb_state *state, uint8_t usage, bool pressed);
+
+/*
+ * Apply an input key event to the key state.
+ *
+ * @param state Key state to update
+ * @param input_code INPUT_KEY_* value
+ * @param pressed True on press, false on release
+ * @return 0 on success, KB_STATE_CONSUMER_CHANGED if the consumer usage
+ *         changed, -ENOENT if the code is not mapped, -ENOSPC if the
+ *         6KRO limit is reached
+ */
+int kb_state_process(struct kb_state *state, uint16_t input_code, bool pressed);
+
+/*
+ * Build the boot protocol keyboard report from the key state.
+ *
+ * @param state Key state to read
+ * @param report Destination buffer of KB_REPORT_COUNT bytes
+ */
+void kb_state_build_report(const struct kb_state *state, uint8_t *report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KEYBOARD_KB_STATE_H */
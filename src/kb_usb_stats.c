@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * USB transfer statistics and completion latency histogram
+ *
+ * Counters are atomics, submitters run in several threads (event
+ * consumer, idle work, polling probe). The histogram is only written
+ * from the completion callback. The HID class keeps one IN transfer in
+ * flight per device, so a single submit timestamp per device is enough.
+ * It is stored before the submit: the completion can run before the
+ * submitter returns, when the submitter is preempted right after it. A
+ * failed submit puts the previous timestamp back, unless another submit
+ * stored its own in the meantime.
+ */
+
+#include "kb_usb_stats.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(kb_usb_stats, CONFIG_KEYBOARD_LOG_LEVEL);
+
+#define STATS_DEV(node_id) DEVICE_DT_GET(node_id),
+
+static const struct device *const stats_devs[] = {
+	DT_FOREACH_STATUS_OKAY(zephyr_hid_device, STATS_DEV)
+};
+
+struct stats_ep {
+	atomic_t submitted;
+	atomic_t completed;
+	atomic_t busy;
+	atomic_t errors;
+	atomic_t bytes;
+	atomic_t out_reports;
+	atomic_t submit_cyc;
+	uint32_t latency[KB_USB_LATENCY_BUCKETS];
+	uint32_t latency_max_us;
+};
+
+static struct stats_ep stats_eps[ARRAY_SIZE(stats_devs)];
+
+static struct stats_ep *stats_ep_get(const struct device *dev)
+{
+	for (unsigned int i = 0; i < ARRAY_SIZE(stats_devs); i++) {
+		if (stats_devs[i] == dev) {
+			return &stats_eps[i];
+		}
+	}
+
+	return NULL;
+}
+
+int kb_usb_submit(const struct device *dev, uint16_t size, const uint8_t *report)
+{
+	struct stats_ep *ep = stats_ep_get(dev);
+	uint32_t now = k_cycle_get_32();
+	atomic_val_t prev;
+	int ret;
+
+	if (ep == NULL) {
+		return hid_device_submit_report(dev, size, report);
+	}
+
+	prev = atomic_set(&ep->submit_cyc, now);
+	ret = hid_device_submit_report(dev, size, report);
+	if (ret == 0) {
+		atomic_inc(&ep->submitted);
+		atomic_add(&ep->bytes, size);
+		return 0;
+	}
+
+	(void)atomic_cas(&ep->submit_cyc, now, prev);
+	if (ret == -EBUSY) {
+		atomic_inc(&ep->busy);
+	} else {
+		atomic_inc(&ep->errors);
+	}
+
+	return ret;
+}
+
+void kb_usb_report_done(const struct device *dev)
+{
+	struct stats_ep *ep = stats_ep_get(dev);
+	uint32_t latency_us;
+	unsigned int bucket;
+
+	if (ep == NULL) {
+		return;
+	}
+
+	latency_us = k_cyc_to_us_floor32(k_cycle_get_32() -
+					 (uint32_t)atomic_get(&ep->submit_cyc));
+	bucket = latency_us == 0U ? 0 : find_msb_set(latency_us) - 1;
+	ep->latency[MIN(bucket, KB_USB_LATENCY_BUCKETS - 1)]++;
+	ep->latency_max_us = MAX(ep->latency_max_us, latency_us);
+	atomic_inc(&ep->completed);
+}
+
+void kb_usb_output_report(const struct device *dev)
+{
+	struct stats_ep *ep = stats_ep_get(dev);
+
+	if (ep != NULL) {
+		atomic_inc(&ep->out_reports);
+	}
+}
+
+int kb_usb_stats_get(const struct device *dev, struct kb_usb_ep_stats *stats)
+{
+	struct stats_ep *ep = stats_ep_get(dev);
+
+	if (ep == NULL) {
+		return -ENODEV;
+	}
+
+	stats->submitted = atomic_get(&ep->submitted);
+	stats->completed = atomic_get(&ep->completed);
+	stats->busy = atomic_get(&ep->busy);
+	stats->errors = atomic_get(&ep->errors);
+	stats->bytes = atomic_get(&ep->bytes);
+	stats->out_reports = atomic_get(&ep->out_reports);
+	memcpy(stats->latency, ep->latency, sizeof(stats->latency));
+	stats->latency_max_us = ep->latency_max_us;
+
+	return 0;
+}
+
+#ifdef CONFIG_KEYBOARD_SHELL
+static int cmd_stats(const struct shell *sh, size_t argc, char **argv)
+{
+	bool reset = argc > 1 && strcmp(argv[1], "reset") == 0;
+
+	if (argc > 1 && !reset) {
+		shell_error(sh, "Unknown argument %s", argv[1]);
+		return -EINVAL;
+	}
+
+	for (unsigned int i = 0; i < ARRAY_SIZE(stats_devs); i++) {
+		struct kb_usb_ep_stats stats;
+
+		if (reset) {
+			/* Racy against a running transfer, good enough for counters */
+			memset(&stats_eps[i], 0, sizeof(stats_eps[i]));
+			continue;
+		}
+
+		kb_usb_stats_get(stats_devs[i], &stats);
+		shell_print(sh, "%s IN: submitted %u, completed %u, busy %u, errors %u, bytes %u",
+			    stats_devs[i]->name, stats.submitted, stats.completed,
+			    stats.busy, stats.errors, stats.bytes);
+		shell_print(sh, "%s OUT: reports %u", stats_devs[i]->name, stats.out_reports);
+		shell_print(sh, "  submit to completion, max %u us:", stats.latency_max_us);
+
+		for (unsigned int b = 0; b < KB_USB_LATENCY_BUCKETS; b++) {
+			if (stats.latency[b] == 0U) {
+				continue;
+			}
+
+			shell_print(sh, "  %6u..%6u us %u", b == 0 ? 0U : (uint32_t)BIT(b),
+				    (uint32_t)BIT(b + 1) - 1U, stats.latency[b]);
+		}
+	}
+
+	return 0;
+}
+
+SHELL_SUBCMD_ADD((kb, usb), stats, NULL,
+		 "Show USB transfer statistics [reset]",
+		 cmd_stats, 1, 1);
+#endif /* CONFIG_KEYBOARD_SHELL */
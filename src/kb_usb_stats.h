@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * USB transfer statistics and completion latency histogram
+ */
+
+#ifndef KEYBOARD_KB_USB_STATS_H
+#define KEYBOARD_KB_USB_STATS_H
+
+#include <stdint.h>
+
+#include <zephyr/device.h>
+#include <zephyr/usb/class/usbd_hid.h>
+
+/* Latency buckets, bucket i counts [2^i, 2^(i+1)) microseconds */
+#define KB_USB_LATENCY_BUCKETS 16
+
+struct kb_usb_ep_stats {
+	uint32_t submitted;
+	uint32_t completed;
+	uint32_t busy;
+	uint32_t errors;
+	uint32_t bytes;
+	uint32_t out_reports;
+	uint32_t latency[KB_USB_LATENCY_BUCKETS];
+	uint32_t latency_max_us;
+};
+
+#ifdef CONFIG_KEYBOARD_USB_STATS
+
+/*
+ * Submit an input report and count it. Drop-in for
+ * hid_device_submit_report().
+ */
+int kb_usb_submit(const struct device *dev, uint16_t size, const uint8_t *report);
+
+/* Count an IN completion, from the input_report_done callback */
+void kb_usb_report_done(const struct device *dev);
+
+/* Count an OUT report, from the output_report callback */
+void kb_usb_output_report(const struct device *dev);
+
+/*
+ * Get the statistics of a HID device's endpoints.
+ *
+ * @param dev HID device
+ * @param stats Set to the statistics
+ * @return 0 on success, -ENODEV if the device is not tracked
+ */
+int kb_usb_stats_get(const struct device *dev, struct kb_usb_ep_stats *stats);
+
+#else
+
+static inline int kb_usb_submit(const struct device *dev, uint16_t size,
+				const uint8_t *report)
+{
+	return hid_device_submit_report(dev, size, report);
+}
+
+static inline void kb_usb_report_done(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+}
+
+static inline void kb_usb_output_report(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+}
+
+#endif /* CONFIG_KEYBOARD_USB_STATS */
+
+#endif /* KEYBOARD_KB_USB_STATS_H */
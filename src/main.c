@@ -3,8 +3,24 @@
  * 88-key USB HID Keyboard implementation
  */
 
+#include "kb_host.h"
+#include "kb_keymap.h"
+#include "kb_link.h"
+#include "kb_macro.h"
+#include "kb_path.h"
+#include "kb_pipeline.h"
+#include "kb_poll.h"
+#include "kb_report.h"
+#include "kb_report_queue.h"
+#include "kb_snapshot.h"
+#include "kb_split.h"
+#include "kb_stamp.h"
+#include "kb_usb_stats.h"
+#include "kb_state.h"
 #include "usbd_init.h"
 
+#include <string.h>
+
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/gpio.h>
@@ -14,9 +30,10 @@
 #include <zephyr/usb/class/usbd_hid.h>
 
 #include <zephyr/logging/log.h>
-LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
+LOG_MODULE_REGISTER(main, CONFIG_KEYBOARD_LOG_LEVEL);
 
-static const uint8_t hid_report_desc[] = HID_KEYBOARD_REPORT_DESC();
+/* IN polling period of the primary interface, as given in devicetree */
+#define KB_IN_POLL_US DT_PROP(DT_NODELABEL(hid_dev_0), in_polling_period_us)
 
 /* LED indices for keyboard status LEDs */
 enum kb_leds_idx {
@@ -32,295 +49,306 @@ static const struct gpio_dt_spec kb_leds[KB_LED_COUNT] = {
 	GPIO_DT_SPEC_GET_OR(DT_ALIAS(led2), gpios, {0}),
 };
 
-/* HID keyboard report structure (8 bytes for boot protocol) */
-enum kb_report_idx {
-	KB_MOD_KEY = 0,
-	KB_RESERVED,
-	KB_KEY_CODE1,
-	KB_KEY_CODE2,
-	KB_KEY_CODE3,
-	KB_KEY_CODE4,
-	KB_KEY_CODE5,
-	KB_KEY_CODE6,
-	KB_REPORT_COUNT,
-};
-
-#define MAX_PRESSED_KEYS 6
-
 struct kb_event {
+	/* INPUT_KEY_* code, or matrix position with KB_EVENT_MATRIX */
 	uint16_t code;
 	int32_t value;
+	/* kb_stamp() when the source detected the change */
+	uint32_t stamp;
 };
 
+#ifdef CONFIG_KEYBOARD_RUN_TO_COMPLETION
+/* Serializes the scan context with the resync work */
+static K_MUTEX_DEFINE(kb_event_lock);
+static void kb_sync_handler(struct k_work *work);
+static K_WORK_DEFINE(kb_sync_work, kb_sync_handler);
+#else
 K_MSGQ_DEFINE(kb_msgq, sizeof(struct kb_event), 16, 4);
-
-UDC_STATIC_BUF_DEFINE(report, KB_REPORT_COUNT);
+#endif
+
+UDC_STATIC_BUF_DEFINE(tx_report, KB_IN_REPORT_SIZE);
+UDC_STATIC_BUF_DEFINE(idle_report, KB_KBD_REPORT_MAX);
+static uint8_t report[KB_KBD_REPORT_MAX];
+#ifdef CONFIG_KEYBOARD_CONSUMER
+static uint8_t consumer_report[KB_CONSUMER_REPORT_SIZE];
+#endif
+static struct kb_report_queue kb_queue;
+static size_t kb_report_len;
+static const struct device *kb_hid_dev;
+static struct usbd_context *kb_usbd;
 static uint32_t kb_duration;
 static bool kb_ready;
+static uint8_t kb_protocol = HID_PROTOCOL_REPORT;
+static uint32_t kb_evt_dropped;
 
-/* Track currently pressed keys (up to 6 for 6KRO) */
-static uint8_t pressed_keys[MAX_PRESSED_KEYS];
-static uint8_t pressed_count;
-static uint8_t modifier_state;
+static struct kb_state kb_state;
 
-/*
- * INPUT_KEY to HID_KEY conversion table
- * Maps Linux input event codes to USB HID keyboard codes
- * Index: INPUT_KEY_* value, Value: HID_KEY_* value (0 = not mapped)
- */
-static const uint8_t input_to_hid_key[] = {
-	[INPUT_KEY_RESERVED] = 0,
-	[INPUT_KEY_ESC] = HID_KEY_ESC,
-	[INPUT_KEY_1] = HID_KEY_1,
-	[INPUT_KEY_2] = HID_KEY_2,
-	[INPUT_KEY_3] = HID_KEY_3,
-	[INPUT_KEY_4] = HID_KEY_4,
-	[INPUT_KEY_5] = HID_KEY_5,
-	[INPUT_KEY_6] = HID_KEY_6,
-	[INPUT_KEY_7] = HID_KEY_7,
-	[INPUT_KEY_8] = HID_KEY_8,
-	[INPUT_KEY_9] = HID_KEY_9,
-	[INPUT_KEY_0] = HID_KEY_0,
-	[INPUT_KEY_MINUS] = HID_KEY_MINUS,
-	[INPUT_KEY_EQUAL] = HID_KEY_EQUAL,
-	[INPUT_KEY_BACKSPACE] = HID_KEY_BACKSPACE,
-	[INPUT_KEY_TAB] = HID_KEY_TAB,
-	[INPUT_KEY_Q] = HID_KEY_Q,
-	[INPUT_KEY_W] = HID_KEY_W,
-	[INPUT_KEY_E] = HID_KEY_E,
-	[INPUT_KEY_R] = HID_KEY_R,
-	[INPUT_KEY_T] = HID_KEY_T,
-	[INPUT_KEY_Y] = HID_KEY_Y,
-	[INPUT_KEY_U] = HID_KEY_U,
-	[INPUT_KEY_I] = HID_KEY_I,
-	[INPUT_KEY_O] = HID_KEY_O,
-	[INPUT_KEY_P] = HID_KEY_P,
-	[INPUT_KEY_LEFTBRACE] = HID_KEY_LEFTBRACE,
-	[INPUT_KEY_RIGHTBRACE] = HID_KEY_RIGHTBRACE,
-	[INPUT_KEY_ENTER] = HID_KEY_ENTER,
-	[INPUT_KEY_LEFTCTRL] = 0, /* Handled as modifier */
-	[INPUT_KEY_A] = HID_KEY_A,
-	[INPUT_KEY_S] = HID_KEY_S,
-	[INPUT_KEY_D] = HID_KEY_D,
-	[INPUT_KEY_F] = HID_KEY_F,
-	[INPUT_KEY_G] = HID_KEY_G,
-	[INPUT_KEY_H] = HID_KEY_H,
-	[INPUT_KEY_J] = HID_KEY_J,
-	[INPUT_KEY_K] = HID_KEY_K,
-	[INPUT_KEY_L] = HID_KEY_L,
-	[INPUT_KEY_SEMICOLON] = HID_KEY_SEMICOLON,
-	[INPUT_KEY_APOSTROPHE] = HID_KEY_APOSTROPHE,
-	[INPUT_KEY_GRAVE] = HID_KEY_GRAVE,
-	[INPUT_KEY_LEFTSHIFT] = 0, /* Handled as modifier */
-	[INPUT_KEY_BACKSLASH] = HID_KEY_BACKSLASH,
-	[INPUT_KEY_Z] = HID_KEY_Z,
-	[INPUT_KEY_X] = HID_KEY_X,
-	[INPUT_KEY_C] = HID_KEY_C,
-	[INPUT_KEY_V] = HID_KEY_V,
-	[INPUT_KEY_B] = HID_KEY_B,
-	[INPUT_KEY_N] = HID_KEY_N,
-	[INPUT_KEY_M] = HID_KEY_M,
-	[INPUT_KEY_COMMA] = HID_KEY_COMMA,
-	[INPUT_KEY_DOT] = HID_KEY_DOT,
-	[INPUT_KEY_SLASH] = HID_KEY_SLASH,
-	[INPUT_KEY_RIGHTSHIFT] = 0, /* Handled as modifier */
-	[INPUT_KEY_KPASTERISK] = HID_KEY_KPASTERISK,
-	[INPUT_KEY_LEFTALT] = 0, /* Handled as modifier */
-	[INPUT_KEY_SPACE] = HID_KEY_SPACE,
-	[INPUT_KEY_CAPSLOCK] = HID_KEY_CAPSLOCK,
-	[INPUT_KEY_F1] = HID_KEY_F1,
-	[INPUT_KEY_F2] = HID_KEY_F2,
-	[INPUT_KEY_F3] = HID_KEY_F3,
-	[INPUT_KEY_F4] = HID_KEY_F4,
-	[INPUT_KEY_F5] = HID_KEY_F5,
-	[INPUT_KEY_F6] = HID_KEY_F6,
-	[INPUT_KEY_F7] = HID_KEY_F7,
-	[INPUT_KEY_F8] = HID_KEY_F8,
-	[INPUT_KEY_F9] = HID_KEY_F9,
-	[INPUT_KEY_F10] = HID_KEY_F10,
-	[INPUT_KEY_NUMLOCK] = HID_KEY_NUMLOCK,
-	[INPUT_KEY_SCROLLLOCK] = HID_KEY_SCROLLLOCK,
-	[INPUT_KEY_KP7] = HID_KEY_KP_7,
-	[INPUT_KEY_KP8] = HID_KEY_KP_8,
-	[INPUT_KEY_KP9] = HID_KEY_KP_9,
-	[INPUT_KEY_KPMINUS] = HID_KEY_KPMINUS,
-	[INPUT_KEY_KP4] = HID_KEY_KP_4,
-	[INPUT_KEY_KP5] = HID_KEY_KP_5,
-	[INPUT_KEY_KP6] = HID_KEY_KP_6,
-	[INPUT_KEY_KPPLUS] = HID_KEY_KPPLUS,
-	[INPUT_KEY_KP1] = HID_KEY_KP_1,
-	[INPUT_KEY_KP2] = HID_KEY_KP_2,
-	[INPUT_KEY_KP3] = HID_KEY_KP_3,
-	[INPUT_KEY_KP0] = HID_KEY_KP_0,
-	[INPUT_KEY_KPDOT] = 99, /* HID_KEY_KPDOT */
-	[INPUT_KEY_F11] = HID_KEY_F11,
-	[INPUT_KEY_F12] = HID_KEY_F12,
-	[INPUT_KEY_KPENTER] = HID_KEY_KPENTER,
-	[INPUT_KEY_RIGHTCTRL] = 0, /* Handled as modifier */
-	[INPUT_KEY_KPSLASH] = HID_KEY_KPSLASH,
-	[INPUT_KEY_SYSRQ] = HID_KEY_SYSRQ,
-	[INPUT_KEY_RIGHTALT] = 0, /* Handled as modifier */
-	[INPUT_KEY_HOME] = HID_KEY_HOME,
-	[INPUT_KEY_UP] = HID_KEY_UP,
-	[INPUT_KEY_PAGEUP] = HID_KEY_PAGEUP,
-	[INPUT_KEY_LEFT] = HID_KEY_LEFT,
-	[INPUT_KEY_RIGHT] = HID_KEY_RIGHT,
-	[INPUT_KEY_END] = HID_KEY_END,
-	[INPUT_KEY_DOWN] = HID_KEY_DOWN,
-	[INPUT_KEY_PAGEDOWN] = HID_KEY_PAGEDOWN,
-	[INPUT_KEY_INSERT] = HID_KEY_INSERT,
-	[INPUT_KEY_DELETE] = HID_KEY_DELETE,
-	[INPUT_KEY_PAUSE] = HID_KEY_PAUSE,
-	[INPUT_KEY_LEFTMETA] = 0, /* Handled as modifier */
-	[INPUT_KEY_RIGHTMETA] = 0, /* Handled as modifier */
-	[INPUT_KEY_COMPOSE] = 101, /* HID_KEY_COMPOSE / Application */
-};
-
-#define INPUT_TO_HID_TABLE_SIZE ARRAY_SIZE(input_to_hid_key)
+static bool kb_boot_format(void)
+{
+	return kb_protocol == HID_PROTOCOL_BOOT;
+}
 
 /*
- * Check if the input key is a modifier key and return the modifier bit
- * Returns 0 if not a modifier
+ * Have the event consumer rebuild the report after a layout change
  */
-static uint8_t get_modifier_bit(uint16_t input_code)
+static void kb_request_sync(void)
 {
-	switch (input_code) {
-	case INPUT_KEY_LEFTCTRL:
-		return HID_KBD_MODIFIER_LEFT_CTRL;
-	case INPUT_KEY_LEFTSHIFT:
-		return HID_KBD_MODIFIER_LEFT_SHIFT;
-	case INPUT_KEY_LEFTALT:
-		return HID_KBD_MODIFIER_LEFT_ALT;
-	case INPUT_KEY_LEFTMETA:
-		return HID_KBD_MODIFIER_LEFT_UI;
-	case INPUT_KEY_RIGHTCTRL:
-		return HID_KBD_MODIFIER_RIGHT_CTRL;
-	case INPUT_KEY_RIGHTSHIFT:
-		return HID_KBD_MODIFIER_RIGHT_SHIFT;
-	case INPUT_KEY_RIGHTALT:
-		return HID_KBD_MODIFIER_RIGHT_ALT;
-	case INPUT_KEY_RIGHTMETA:
-		return HID_KBD_MODIFIER_RIGHT_UI;
-	default:
-		return 0;
+#ifdef CONFIG_KEYBOARD_RUN_TO_COMPLETION
+	/* Also called from the USB stack thread, resync from the work queue */
+	k_work_submit(&kb_sync_work);
+#else
+	struct kb_event kb_evt = {
+		.code = KB_EVENT_SYNC,
+		.stamp = kb_stamp(),
+	};
+
+	if (k_msgq_put(&kb_msgq, &kb_evt, K_NO_WAIT) != 0) {
+		LOG_WRN("Failed to queue report rebuild");
 	}
+#endif
 }
 
 /*
- * Convert INPUT_KEY code to HID key code
- * Returns 0 if not mappable (modifiers return 0 here, handled separately)
+ * Process a key event, update state and rebuild the HID report.
+ * Returns KB_STATE_CONSUMER_CHANGED if only the consumer report changed,
+ * -EALREADY if the keyboard report did not change.
  */
-static uint8_t input_to_hid(uint16_t input_code)
+static int process_key_event(uint16_t code, bool pressed, uint32_t stamp)
 {
-	if (input_code < INPUT_TO_HID_TABLE_SIZE) {
-		return input_to_hid_key[input_code];
+	int ret = kb_pipeline_process(&kb_state, code, pressed, stamp);
+
+	if (ret == KB_STATE_CONSUMER_CHANGED) {
+		return ret;
+	} else if (ret == -ENOSPC) {
+		/* The key is still in the bitmap for NKRO or split reports */
+		if (!IS_ENABLED(CONFIG_KEYBOARD_KEY_BITMAP)) {
+			LOG_WRN("6KRO limit reached, key ignored");
+		}
+	} else if (ret == -ENOENT || ret == -ENOTSUP) {
+		LOG_DBG("Unmapped key code: 0x%04x", code);
 	}
+
+#ifdef CONFIG_KEYBOARD_SPLIT_BOOT
+	bool changed = kb_split_update(&kb_state, report, stamp);
+
+	kb_report_len = KB_BOOT_REPORT_SIZE;
+	kb_snapshot_publish(report, kb_report_len);
+
+	/* Only the secondary interfaces changed, they are already submitted */
+	return changed || code == KB_EVENT_SYNC ? 0 : -EALREADY;
+#else
+	kb_report_len = kb_report_build_keyboard(&kb_state, kb_boot_format(), report);
+	kb_snapshot_publish(report, kb_report_len);
+
 	return 0;
+#endif
 }
 
 /*
- * Add a key to the pressed keys array
- * Returns true if the key was added or already present
+ * Re-send the current report when the host's idle period expires
  */
-static bool add_pressed_key(uint8_t hid_key)
+static void kb_idle_handler(struct k_work *work)
 {
-	/* Check if already pressed */
-	for (int i = 0; i < pressed_count; i++) {
-		if (pressed_keys[i] == hid_key) {
-			return true;
-		}
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	uint32_t duration = kb_duration;
+	size_t len;
+	int ret;
+
+	if (duration == 0U || !kb_ready) {
+		return;
 	}
 
-	/* Add if room available */
-	if (pressed_count < MAX_PRESSED_KEYS) {
-		pressed_keys[pressed_count++] = hid_key;
-		return true;
+	kb_snapshot_read(idle_report, &len);
+	ret = kb_usb_submit(kb_hid_dev, len, idle_report);
+	if (ret != 0 && ret != -EBUSY) {
+		LOG_WRN("Idle report submit error, %d", ret);
 	}
 
-	LOG_WRN("6KRO limit reached, key ignored");
-	return false;
+	k_work_reschedule(dwork, K_MSEC(duration));
 }
 
+static K_WORK_DELAYABLE_DEFINE(kb_idle_work, kb_idle_handler);
+
 /*
- * Remove a key from the pressed keys array
+ * Handle one key event: update the state, build and submit the reports
  */
-static void remove_pressed_key(uint8_t hid_key)
+static void kb_handle_event(const struct kb_event *evt)
 {
-	for (int i = 0; i < pressed_count; i++) {
-		if (pressed_keys[i] == hid_key) {
-			/* Shift remaining keys */
-			for (int j = i; j < pressed_count - 1; j++) {
-				pressed_keys[j] = pressed_keys[j + 1];
+	int changed;
+	int ret;
+
+	/* Process the key event */
+	changed = process_key_event(evt->code, evt->value != 0, evt->stamp);
+	if (changed == -EALREADY) {
+		return;
+	}
+
+	if (!kb_ready) {
+		LOG_DBG("USB HID device is not ready");
+		return;
+	}
+
+	/* Handle remote wakeup if suspended */
+	if (IS_ENABLED(CONFIG_KEYBOARD_USBD_REMOTE_WAKEUP) &&
+	    usbd_is_suspended(kb_usbd)) {
+		if (evt->value) {
+			ret = usbd_wakeup_request(kb_usbd);
+			if (ret) {
+				LOG_ERR("Remote wakeup error, %d", ret);
 			}
-			pressed_count--;
-			return;
+		}
+		return;
+	}
+
+#ifdef CONFIG_KEYBOARD_CONSUMER
+	/* A resync resends both reports, boot hosts only parse the keyboard one */
+	if ((changed == KB_STATE_CONSUMER_CHANGED || evt->code == KB_EVENT_SYNC) &&
+	    !kb_boot_format()) {
+		ret = kb_report_queue_put(&kb_queue, consumer_report,
+					  kb_report_build_consumer(&kb_state,
+								   consumer_report),
+					  evt->stamp);
+		if (ret) {
+			LOG_ERR("HID submit consumer report error, %d", ret);
 		}
 	}
+
+	if (changed == KB_STATE_CONSUMER_CHANGED) {
+		return;
+	}
+#endif
+
+	/* Submit the HID report, queued behind a transfer in flight */
+	ret = kb_report_queue_put(&kb_queue, report, kb_report_len, evt->stamp);
+	if (ret) {
+		LOG_ERR("HID submit report error, %d", ret);
+	} else if (kb_duration != 0U) {
+		/* The idle period restarts with every report */
+		k_work_reschedule(&kb_idle_work, K_MSEC(kb_duration));
+	}
 }
 
+#ifdef CONFIG_KEYBOARD_RUN_TO_COMPLETION
 /*
- * Build the HID report from current state
+ * Run the whole chain in the caller's context, the input driver's scan
+ * thread with INPUT_MODE_SYNCHRONOUS
  */
-static void build_hid_report(void)
+static void kb_dispatch(const struct kb_event *evt)
+{
+	uint32_t start;
+
+	k_mutex_lock(&kb_event_lock, K_FOREVER);
+	start = kb_stamp();
+	kb_handle_event(evt);
+	kb_path_record(evt->stamp, start);
+	k_mutex_unlock(&kb_event_lock);
+}
+
+static void kb_sync_handler(struct k_work *work)
 {
-	memset(report, 0, KB_REPORT_COUNT);
+	struct kb_event kb_evt = {
+		.code = KB_EVENT_SYNC,
+		.stamp = kb_stamp(),
+	};
 
-	report[KB_MOD_KEY] = modifier_state;
-	report[KB_RESERVED] = 0;
+	ARG_UNUSED(work);
+
+	kb_dispatch(&kb_evt);
+}
+#endif
 
-	for (int i = 0; i < pressed_count && i < MAX_PRESSED_KEYS; i++) {
-		report[KB_KEY_CODE1 + i] = pressed_keys[i];
+/*
+ * Hand a key event to the engine
+ */
+static void kb_post_event(struct kb_event *kb_evt)
+{
+#ifdef CONFIG_KEYBOARD_RUN_TO_COMPLETION
+	kb_dispatch(kb_evt);
+#else
+	if (k_msgq_put(&kb_msgq, kb_evt, K_NO_WAIT) != 0) {
+		kb_evt_dropped++;
+		LOG_ERR("Failed to put new input event, %u dropped", kb_evt_dropped);
 	}
+#endif
 }
 
 /*
- * Process a key event and update state
+ * Replay a recorded transition like an input event
  */
-static void process_key_event(uint16_t input_code, bool pressed)
+static void kb_macro_play_event(uint16_t code, bool pressed)
 {
-	uint8_t mod_bit = get_modifier_bit(input_code);
-
-	if (mod_bit != 0) {
-		/* Handle modifier keys */
-		if (pressed) {
-			modifier_state |= mod_bit;
-		} else {
-			modifier_state &= ~mod_bit;
-		}
+	struct kb_event kb_evt = {
+		.code = code,
+		.value = pressed,
+		.stamp = kb_stamp(),
+	};
+
+	kb_post_event(&kb_evt);
+}
+
+/*
+ * Stamp for the next key event of a device, see kb_stamp_report(). A
+ * stamp of another device or one never followed by a key event is
+ * replaced.
+ */
+static struct k_spinlock kb_stamp_lock;
+static const struct device *kb_stamp_dev;
+static uint32_t kb_stamp_next;
+
+static void kb_put_stamp(const struct device *dev, uint32_t stamp)
+{
+	k_spinlock_key_t key = k_spin_lock(&kb_stamp_lock);
+
+	kb_stamp_dev = dev;
+	kb_stamp_next = stamp;
+	k_spin_unlock(&kb_stamp_lock, key);
+}
+
+static uint32_t kb_take_stamp(const struct device *dev)
+{
+	k_spinlock_key_t key = k_spin_lock(&kb_stamp_lock);
+	uint32_t stamp;
+
+	if (dev != NULL && dev == kb_stamp_dev) {
+		stamp = kb_stamp_next;
 	} else {
-		/* Handle regular keys */
-		uint8_t hid_key = input_to_hid(input_code);
-
-		if (hid_key != 0) {
-			if (pressed) {
-				add_pressed_key(hid_key);
-			} else {
-				remove_pressed_key(hid_key);
-			}
-		} else {
-			LOG_DBG("Unmapped input code: %u", input_code);
-		}
+		/* No detection time from the source, stamp on arrival */
+		stamp = kb_stamp();
 	}
+	kb_stamp_dev = NULL;
+	k_spin_unlock(&kb_stamp_lock, key);
 
-	build_hid_report();
+	return stamp;
 }
 
 static void input_cb(struct input_event *evt, void *user_data)
 {
 	struct kb_event kb_evt;
+	uint16_t pos;
+	bool pressed;
 
 	ARG_UNUSED(user_data);
 
-	/* Only process key events */
-	if (evt->type != INPUT_EV_KEY) {
+	if (evt->type == KB_INPUT_EV_STAMP) {
+		kb_put_stamp(evt->dev, (uint32_t)evt->value);
 		return;
 	}
 
-	kb_evt.code = evt->code;
-	kb_evt.value = evt->value;
-	if (k_msgq_put(&kb_msgq, &kb_evt, K_NO_WAIT) != 0) {
-		LOG_ERR("Failed to put new input event");
+	if (IS_ENABLED(CONFIG_KEYBOARD_GENERATED_KEYMAP) &&
+	    kb_keymap_input(evt, &pos, &pressed)) {
+		/* Raw matrix position, resolved by the generated keymap */
+		kb_evt.code = pos | KB_EVENT_MATRIX;
+		kb_evt.value = pressed;
+	} else if (evt->type == INPUT_EV_KEY && evt->code != INPUT_BTN_TOUCH) {
+		kb_evt.code = evt->code;
+		kb_evt.value = evt->value;
+	} else {
+		/* Only process key events */
+		return;
 	}
+
+	kb_evt.stamp = kb_take_stamp(evt->dev);
+	kb_post_event(&kb_evt);
 }
 
 INPUT_CALLBACK_DEFINE(NULL, input_cb, NULL);
@@ -330,17 +358,79 @@ static void kb_iface_ready(const struct device *dev, const bool ready)
 	LOG_INF("HID device %s interface is %s",
 		dev->name, ready ? "ready" : "not ready");
 	kb_ready = ready;
+
+	if (!ready) {
+		kb_report_queue_flush(&kb_queue);
+
+		if (IS_ENABLED(CONFIG_KEYBOARD_POLL_MONITOR)) {
+			kb_poll_probe_abort(-ENETDOWN);
+		}
+	}
+
+	kb_link_on_ready(ready);
+
+	if (IS_ENABLED(CONFIG_KEYBOARD_POLL_PROBE_ON_READY) && ready) {
+		kb_poll_set_expected(KB_IN_POLL_US);
+		(void)kb_poll_probe_start(dev, CONFIG_KEYBOARD_POLL_PROBE_COUNT);
+	}
 }
 
 static int kb_get_report(const struct device *dev,
 			 const uint8_t type, const uint8_t id, const uint16_t len,
 			 uint8_t *const buf)
 {
-	if (type == HID_REPORT_TYPE_INPUT && len >= KB_REPORT_COUNT) {
-		memcpy(buf, report, KB_REPORT_COUNT);
-		return KB_REPORT_COUNT;
+	if (IS_ENABLED(CONFIG_KEYBOARD_HOST_DETECT)) {
+		kb_host_on_report();
+	}
+
+	if (type == HID_REPORT_TYPE_INPUT &&
+	    (id == 0U || id == KB_REPORT_ID_KEYBOARD)) {
+		uint8_t current[KB_KBD_REPORT_MAX];
+		size_t size;
+
+		/* Called from the USB stack, may race with the event consumer */
+		kb_snapshot_read(current, &size);
+		if (len >= size) {
+			memcpy(buf, current, size);
+			return size;
+		}
 	}
 
+#ifdef CONFIG_KEYBOARD_VENDOR_REPORT
+	if (type == HID_REPORT_TYPE_INPUT && id == KB_REPORT_ID_VENDOR &&
+	    len >= KB_VENDOR_REPORT_SIZE) {
+		struct kb_report_status status = {
+			.protocol = kb_protocol,
+			.host = IS_ENABLED(CONFIG_KEYBOARD_HOST_DETECT) ?
+				kb_host_type_get(NULL) : KB_HOST_UNKNOWN,
+			.evt_dropped = kb_evt_dropped,
+		};
+
+		if (IS_ENABLED(CONFIG_KEYBOARD_USB_STATS)) {
+			struct kb_usb_ep_stats usb;
+
+			if (kb_usb_stats_get(dev, &usb) == 0) {
+				status.usb_busy = MIN(usb.busy, UINT16_MAX);
+				status.usb_errors = MIN(usb.errors, UINT16_MAX);
+			}
+		}
+
+		if (IS_ENABLED(CONFIG_KEYBOARD_POLL_MONITOR)) {
+			struct kb_poll_stats poll;
+
+			kb_poll_get(&poll);
+			status.poll_us = MIN(poll.avg_us, UINT16_MAX);
+			status.poll_missed = MIN(poll.missed, UINT16_MAX);
+			status.poll_flags = (poll.running ? KB_STATUS_POLL_RUNNING : 0U) |
+					    (poll.aborted ? KB_STATUS_POLL_ABORTED : 0U) |
+					    (!poll.running && poll.samples < poll.requested ?
+					     KB_STATUS_POLL_PARTIAL : 0U);
+		}
+
+		return kb_report_build_vendor(&status, buf);
+	}
+#endif
+
 	LOG_WRN("Get Report not implemented, Type %u ID %u", type, id);
 	return 0;
 }
@@ -349,18 +439,29 @@ static int kb_set_report(const struct device *dev,
 			 const uint8_t type, const uint8_t id, const uint16_t len,
 			 const uint8_t *const buf)
 {
+	int leds;
+
+	if (IS_ENABLED(CONFIG_KEYBOARD_HOST_DETECT)) {
+		kb_host_on_report();
+	}
+
 	if (type != HID_REPORT_TYPE_OUTPUT) {
 		LOG_WRN("Unsupported report type");
 		return -ENOTSUP;
 	}
 
+	leds = kb_report_parse_leds(kb_boot_format(), len, buf);
+	if (leds < 0) {
+		return leds;
+	}
+
 	/* Handle LED state from host */
 	for (unsigned int i = 0; i < ARRAY_SIZE(kb_leds); i++) {
 		if (kb_leds[i].port == NULL) {
 			continue;
 		}
 
-		(void)gpio_pin_set_dt(&kb_leds[i], buf[0] & BIT(i));
+		(void)gpio_pin_set_dt(&kb_leds[i], leds & BIT(i));
 	}
 
 	return 0;
@@ -371,6 +472,16 @@ static void kb_set_idle(const struct device *dev,
 {
 	LOG_INF("Set Idle %u to %u", id, duration);
 	kb_duration = duration;
+
+	if (IS_ENABLED(CONFIG_KEYBOARD_HOST_DETECT)) {
+		kb_host_on_idle(duration);
+	}
+
+	if (duration != 0U) {
+		k_work_reschedule(&kb_idle_work, K_MSEC(duration));
+	} else {
+		k_work_cancel_delayable(&kb_idle_work);
+	}
 }
 
 static uint32_t kb_get_idle(const struct device *dev, const uint8_t id)
@@ -382,13 +493,38 @@ static uint32_t kb_get_idle(const struct device *dev, const uint8_t id)
 static void kb_set_protocol(const struct device *dev, const uint8_t proto)
 {
 	LOG_INF("Protocol changed to %s",
-		proto == 0U ? "Boot Protocol" : "Report Protocol");
+		proto == HID_PROTOCOL_BOOT ? "Boot Protocol" : "Report Protocol");
+	kb_protocol = proto;
+
+	if (IS_ENABLED(CONFIG_KEYBOARD_HOST_DETECT)) {
+		kb_host_on_protocol(proto);
+	}
+
+	/* The report layout changed */
+	kb_request_sync();
+}
+
+static void kb_input_report_done(const struct device *dev,
+				 const uint8_t *const report)
+{
+	kb_usb_report_done(dev);
+	kb_report_queue_done(&kb_queue, report);
+	kb_link_report_done();
+
+	if (IS_ENABLED(CONFIG_KEYBOARD_DYNAMIC_MACRO)) {
+		kb_macro_report_done();
+	}
+
+	if (IS_ENABLED(CONFIG_KEYBOARD_POLL_MONITOR)) {
+		(void)kb_poll_report_done(dev, report);
+	}
 }
 
 static void kb_output_report(const struct device *dev, const uint16_t len,
 			     const uint8_t *const buf)
 {
 	LOG_HEXDUMP_DBG(buf, len, "o.r.");
+	kb_usb_output_report(dev);
 	kb_set_report(dev, HID_REPORT_TYPE_OUTPUT, 0U, len, buf);
 }
 
@@ -399,6 +535,7 @@ struct hid_device_ops kb_ops = {
 	.set_idle = kb_set_idle,
 	.get_idle = kb_get_idle,
 	.set_protocol = kb_set_protocol,
+	.input_report_done = kb_input_report_done,
 	.output_report = kb_output_report,
 };
 
@@ -407,6 +544,12 @@ static void msg_cb(struct usbd_context *const usbd_ctx,
 {
 	LOG_INF("USBD message: %s", usbd_msg_type_string(msg->type));
 
+	if (IS_ENABLED(CONFIG_KEYBOARD_HOST_DETECT)) {
+		kb_host_on_msg(msg->type);
+	}
+
+	kb_link_on_msg(msg->type);
+
 	if (msg->type == USBD_MSG_CONFIGURATION) {
 		LOG_INF("\tConfiguration value %d", msg->status);
 	}
@@ -426,10 +569,42 @@ static void msg_cb(struct usbd_context *const usbd_ctx,
 	}
 }
 
+/*
+ * Apply the behavior selected for the detected host
+ */
+static void kb_host_apply(enum kb_host_type type,
+			  const struct kb_host_profile *profile)
+{
+	ARG_UNUSED(type);
+
+	if (profile->idle_ms != 0U && kb_duration == 0U) {
+		kb_duration = profile->idle_ms;
+		k_work_reschedule(&kb_idle_work, K_MSEC(kb_duration));
+	}
+}
+
+/*
+ * Recover from bus resets, reconfigurations and resumes
+ */
+static void kb_link_apply(enum kb_link_state state)
+{
+	if (state == KB_LINK_DEFAULT) {
+		/* HID 1.11 7.2.6: a reset returns the device to report protocol */
+		kb_protocol = HID_PROTOCOL_REPORT;
+		kb_duration = 0;
+		k_work_cancel_delayable(&kb_idle_work);
+		kb_report_queue_flush(&kb_queue);
+	}
+
+	/* Rebuild with the current settings, resent once the interface is ready */
+	kb_request_sync();
+}
+
 int main(void)
 {
-	struct usbd_context *kbd_usbd;
 	const struct device *hid_dev;
+	const uint8_t *desc;
+	size_t desc_size;
 	int ret;
 
 	/* Initialize LEDs */
@@ -451,22 +626,32 @@ int main(void)
 	}
 
 	/* Initialize HID device */
-	hid_dev = DEVICE_DT_GET_ONE(zephyr_hid_device);
+	/* With split interfaces there are several, hid_dev_0 is the primary */
+	hid_dev = DEVICE_DT_GET(DT_NODELABEL(hid_dev_0));
 	if (!device_is_ready(hid_dev)) {
 		LOG_ERR("HID Device is not ready");
 		return -EIO;
 	}
 
-	ret = hid_device_register(hid_dev,
-				  hid_report_desc, sizeof(hid_report_desc),
-				  &kb_ops);
+	kb_hid_dev = hid_dev;
+	kb_report_queue_init(&kb_queue, hid_dev, tx_report);
+
+	desc = kb_report_desc(&desc_size);
+	ret = hid_device_register(hid_dev, desc, desc_size, &kb_ops);
 	if (ret != 0) {
 		LOG_ERR("Failed to register HID Device, %d", ret);
 		return ret;
 	}
 
+	if (IS_ENABLED(CONFIG_KEYBOARD_SPLIT_BOOT)) {
+		ret = kb_split_init(hid_dev);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
 	if (IS_ENABLED(CONFIG_USBD_HID_SET_POLLING_PERIOD)) {
-		ret = hid_device_set_in_polling(hid_dev, 1000);
+		ret = hid_device_set_in_polling(hid_dev, KB_IN_POLL_US);
 		if (ret) {
 			LOG_WRN("Failed to set IN report polling period, %d", ret);
 		}
@@ -477,55 +662,58 @@ int main(void)
 		}
 	}
 
+	if (IS_ENABLED(CONFIG_KEYBOARD_HOST_DETECT)) {
+		kb_host_init(kb_host_apply);
+	}
+
+	kb_link_init(kb_link_apply);
+
+	if (IS_ENABLED(CONFIG_KEYBOARD_DYNAMIC_MACRO)) {
+		kb_macro_init(kb_macro_play_event);
+	}
+
 	/* Initialize USB device */
-	kbd_usbd = keyboard_usbd_init(msg_cb);
-	if (kbd_usbd == NULL) {
+	kb_usbd = keyboard_usbd_init(msg_cb);
+	if (kb_usbd == NULL) {
 		LOG_ERR("Failed to initialize USB device");
 		return -ENODEV;
 	}
 
-	if (!usbd_can_detect_vbus(kbd_usbd)) {
-		ret = usbd_enable(kbd_usbd);
+	if (!usbd_can_detect_vbus(kb_usbd)) {
+		ret = usbd_enable(kb_usbd);
 		if (ret) {
 			LOG_ERR("Failed to enable device support");
 			return ret;
 		}
 	}
 
+	/* Publish the empty report before the first key event */
+#ifdef CONFIG_KEYBOARD_RUN_TO_COMPLETION
+	k_mutex_lock(&kb_event_lock, K_FOREVER);
+	process_key_event(KB_EVENT_SYNC, false, kb_stamp());
+	k_mutex_unlock(&kb_event_lock);
+#else
+	process_key_event(KB_EVENT_SYNC, false, kb_stamp());
+#endif
+
 	LOG_INF("88-key HID keyboard initialized");
 
+#ifdef CONFIG_KEYBOARD_RUN_TO_COMPLETION
+	/* Events are handled in the input callback, nothing left to do here */
+	return 0;
+#else
 	/* Main event loop */
 	while (true) {
 		struct kb_event kb_evt;
+		uint32_t start;
 
 		k_msgq_get(&kb_msgq, &kb_evt, K_FOREVER);
 
-		/* Process the key event */
-		process_key_event(kb_evt.code, kb_evt.value != 0);
-
-		if (!kb_ready) {
-			LOG_DBG("USB HID device is not ready");
-			continue;
-		}
-
-		/* Handle remote wakeup if suspended */
-		if (IS_ENABLED(CONFIG_KEYBOARD_USBD_REMOTE_WAKEUP) &&
-		    usbd_is_suspended(kbd_usbd)) {
-			if (kb_evt.value) {
-				ret = usbd_wakeup_request(kbd_usbd);
-				if (ret) {
-					LOG_ERR("Remote wakeup error, %d", ret);
-				}
-			}
-			continue;
-		}
-
-		/* Submit the HID report */
-		ret = hid_device_submit_report(hid_dev, KB_REPORT_COUNT, report);
-		if (ret) {
-			LOG_ERR("HID submit report error, %d", ret);
-		}
+		start = kb_stamp();
+		kb_handle_event(&kb_evt);
+		kb_path_record(kb_evt.stamp, start);
 	}
 
 	return 0;
+#endif
 }
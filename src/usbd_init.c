@@ -11,7 +11,7 @@
 #include <zephyr/usb/usbd.h>
 
 #include <zephyr/logging/log.h>
-LOG_MODULE_REGISTER(usbd_keyboard_config);
+LOG_MODULE_REGISTER(usbd_keyboard_config, CONFIG_KEYBOARD_LOG_LEVEL);
 
 /*
  * Instantiate USB device context using configured VID/PID
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Dynamic macro recording and playback tests
+ */
+
+#include "kb_macro.h"
+#include "kb_stamp.h"
+
+#include <errno.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+/* Matrix positions in keymap/tkl_fn.keymap, flagged like KB_EVENT_MATRIX */
+#define KEY(pos) (BIT(15) | (pos))
+#define KEY_DM_REC KEY(1)
+#define KEY_A KEY(52)
+#define KEY_S KEY(53)
+#define KEY_FN KEY(97)
+
+/* Long enough for every transition of a short macro to play */
+#define PLAY_MS 200
+
+struct played {
+	uint16_t code;
+	bool pressed;
+};
+
+static struct played played[16];
+static size_t played_count;
+
+static void macro_played(uint16_t code, bool pressed)
+{
+	if (played_count < ARRAY_SIZE(played)) {
+		played[played_count++] = (struct played){ code, pressed };
+	}
+}
+
+static void record(uint16_t code, bool pressed)
+{
+	kb_macro_record(code, pressed, kb_stamp());
+}
+
+static void assert_played(size_t i, uint16_t code, bool pressed)
+{
+	zassert_true(i < played_count, "transition %zu not played", i);
+	zassert_equal(played[i].code, code, "transition %zu", i);
+	zassert_equal(played[i].pressed, pressed, "transition %zu", i);
+}
+
+static void kb_macro_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	kb_macro_stop();
+	(void)kb_macro_record_stop();
+	kb_macro_init(macro_played);
+	played_count = 0;
+}
+
+ZTEST_SUITE(kb_macro, NULL, NULL, kb_macro_before, NULL, NULL);
+
+ZTEST(kb_macro, test_stop_with_layer_key_held)
+{
+	struct kb_macro_info info;
+
+	/* Fn held and DM_REC pressed start it, both released inside */
+	zassert_ok(kb_macro_record_toggle());
+	record(KEY_DM_REC, false);
+	record(KEY_FN, false);
+
+	record(KEY_A, true);
+	record(KEY_A, false);
+
+	/* Fn and DM_REC pressed again stop it, their releases come after */
+	record(KEY_FN, true);
+	record(KEY_DM_REC, true);
+	zassert_ok(kb_macro_record_toggle());
+	record(KEY_DM_REC, false);
+	record(KEY_FN, false);
+
+	/* Only the A stroke is left, the layer key is neither pressed nor released */
+	kb_macro_get(&info);
+	zassert_equal(info.state, KB_MACRO_IDLE);
+	zassert_equal(info.transitions, 2);
+
+	zassert_ok(kb_macro_play());
+	k_msleep(PLAY_MS);
+
+	zassert_equal(played_count, 2);
+	assert_played(0, KEY_A, true);
+	assert_played(1, KEY_A, false);
+	kb_macro_get(&info);
+	zassert_equal(info.state, KB_MACRO_IDLE);
+}
+
+ZTEST(kb_macro, test_stop_keeps_delay)
+{
+	struct kb_macro_info info;
+
+	zassert_ok(kb_macro_record_start());
+	record(KEY_A, true);
+	/* S is still held at the stop, its press is cut from A's stroke */
+	record(KEY_S, true);
+	k_msleep(20);
+	record(KEY_A, false);
+	zassert_ok(kb_macro_record_stop());
+
+	kb_macro_get(&info);
+	zassert_equal(info.transitions, 2);
+	zassert_true(info.duration_ms >= 20, "%u ms", info.duration_ms);
+
+	zassert_ok(kb_macro_play());
+	k_msleep(PLAY_MS);
+
+	zassert_equal(played_count, 2);
+	assert_played(0, KEY_A, true);
+	assert_played(1, KEY_A, false);
+}
+
+ZTEST(kb_macro, test_stop_playback_releases)
+{
+	zassert_ok(kb_macro_record_start());
+	record(KEY_A, true);
+	k_msleep(PLAY_MS);
+	record(KEY_A, false);
+	zassert_ok(kb_macro_record_stop());
+
+	/* Stopped between the press and the release */
+	zassert_ok(kb_macro_play());
+	k_msleep(PLAY_MS / 4);
+	zassert_equal(played_count, 1);
+	kb_macro_stop();
+
+	zassert_equal(played_count, 2);
+	assert_played(1, KEY_A, false);
+
+	/* Nothing follows from the macro itself */
+	k_msleep(PLAY_MS * 2);
+	zassert_equal(played_count, 2);
+}
+
+ZTEST(kb_macro, test_play_busy_and_empty)
+{
+	/* An empty recording replaces the macro of the previous case */
+	zassert_ok(kb_macro_record_start());
+	zassert_ok(kb_macro_record_stop());
+	zassert_equal(kb_macro_play(), -ENODATA);
+
+	zassert_ok(kb_macro_record_start());
+	zassert_equal(kb_macro_play(), -EBUSY);
+	zassert_ok(kb_macro_record_stop());
+	zassert_equal(kb_macro_record_stop(), -EALREADY);
+}
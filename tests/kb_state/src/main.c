@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * Key state tracking and boot report building tests
+ */
+
+#include "kb_state.h"
+
+#include <errno.h>
+
+#include <zephyr/input/input.h>
+#include <zephyr/usb/class/hid.h>
+#include <zephyr/ztest.h>
+
+BUILD_ASSERT(!IS_ENABLED(CONFIG_KB_STATE_TEST_NKRO) ||
+	     IS_ENABLED(CONFIG_KEYBOARD_KEY_BITMAP),
+	     "The NKRO scenario runs without the key bitmap");
+
+static struct kb_state state;
+
+static void kb_state_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	kb_state_reset(&state);
+}
+
+ZTEST_SUITE(kb_state, NULL, NULL, kb_state_before, NULL, NULL);
+
+ZTEST(kb_state, test_press_release_order)
+{
+	static const uint8_t keys[] = { HID_KEY_A, HID_KEY_B, HID_KEY_C, HID_KEY_D };
+
+	ARRAY_FOR_EACH(keys, i) {
+		zassert_ok(kb_state_press(&state, keys[i]));
+	}
+	zassert_equal(state.pressed_count, 4);
+	zassert_mem_equal(state.pressed_keys, keys, sizeof(keys));
+
+	/* Releasing from the middle keeps the order of the rest */
+	kb_state_release(&state, HID_KEY_B);
+	zassert_equal(state.pressed_count, 3);
+	zassert_equal(state.pressed_keys[0], HID_KEY_A);
+	zassert_equal(state.pressed_keys[1], HID_KEY_C);
+	zassert_equal(state.pressed_keys[2], HID_KEY_D);
+
+	/* A key pressed again goes to the end */
+	zassert_ok(kb_state_press(&state, HID_KEY_B));
+	zassert_equal(state.pressed_keys[3], HID_KEY_B);
+
+	/* Releasing a key that is not pressed changes nothing */
+	kb_state_release(&state, HID_KEY_Z);
+	zassert_equal(state.pressed_count, 4);
+}
+
+ZTEST(kb_state, test_seventh_key)
+{
+	uint8_t report[KB_REPORT_COUNT];
+
+	for (int i = 0; i < KB_MAX_PRESSED_KEYS; i++) {
+		zassert_ok(kb_state_press(&state, HID_KEY_A + i));
+	}
+
+	zassert_equal(kb_state_press(&state, HID_KEY_Z), -ENOSPC);
+	zassert_equal(state.pressed_count, KB_MAX_PRESSED_KEYS);
+
+	/* The boot report keeps the first six keys */
+	kb_state_build_report(&state, report);
+	for (int i = 0; i < KB_MAX_PRESSED_KEYS; i++) {
+		zassert_equal(report[KB_KEY_CODE1 + i], HID_KEY_A + i);
+	}
+
+#ifdef CONFIG_KEYBOARD_KEY_BITMAP
+	/* The bitmap still records the seventh key */
+	zassert_true(state.key_bitmap[HID_KEY_Z / 8] & BIT(HID_KEY_Z % 8));
+#endif
+
+	/* A free slot takes the next key again */
+	kb_state_release(&state, HID_KEY_C);
+	zassert_ok(kb_state_press(&state, HID_KEY_Z));
+	zassert_equal(state.pressed_keys[KB_MAX_PRESSED_KEYS - 1], HID_KEY_Z);
+}
+
+ZTEST(kb_state, test_duplicate_press)
+{
+	zassert_ok(kb_state_press(&state, HID_KEY_A));
+	zassert_ok(kb_state_press(&state, HID_KEY_B));
+	zassert_ok(kb_state_press(&state, HID_KEY_A));
+	zassert_equal(state.pressed_count, 2);
+
+	/* One release clears the key however often it was pressed */
+	kb_state_release(&state, HID_KEY_A);
+	zassert_equal(state.pressed_count, 1);
+	zassert_equal(state.pressed_keys[0], HID_KEY_B);
+
+#ifdef CONFIG_KEYBOARD_KEY_BITMAP
+	zassert_false(state.key_bitmap[HID_KEY_A / 8] & BIT(HID_KEY_A % 8));
+#endif
+}
+
+ZTEST(kb_state, test_modifiers)
+{
+	zassert_ok(kb_state_process(&state, INPUT_KEY_LEFTSHIFT, true));
+	zassert_ok(kb_state_process(&state, INPUT_KEY_RIGHTALT, true));
+	zassert_equal(state.modifiers,
+		      HID_KBD_MODIFIER_LEFT_SHIFT | HID_KBD_MODIFIER_RIGHT_ALT);
+
+	/* Modifiers take no slot in the key list */
+	zassert_equal(state.pressed_count, 0);
+
+	zassert_ok(kb_state_process(&state, INPUT_KEY_LEFTSHIFT, false));
+	zassert_equal(state.modifiers, HID_KBD_MODIFIER_RIGHT_ALT);
+
+	/* Modifier usages from the keymap set the same bits */
+	zassert_ok(kb_state_process_hid(&state, HID_KBD_USAGE_MODIFIER_FIRST, true));
+	zassert_ok(kb_state_process_hid(&state, HID_KBD_USAGE_MODIFIER_FIRST + 7, true));
+	zassert_equal(state.modifiers, HID_KBD_MODIFIER_LEFT_CTRL |
+		      HID_KBD_MODIFIER_RIGHT_ALT | HID_KBD_MODIFIER_RIGHT_UI);
+	zassert_ok(kb_state_process_hid(&state, HID_KBD_USAGE_MODIFIER_FIRST + 7, false));
+	zassert_equal(state.modifiers,
+		      HID_KBD_MODIFIER_LEFT_CTRL | HID_KBD_MODIFIER_RIGHT_ALT);
+	zassert_equal(state.pressed_count, 0);
+}
+
+ZTEST(kb_state, test_unmapped_code)
+{
+	zassert_equal(kb_state_process(&state, INPUT_KEY_RESERVED, true), -ENOENT);
+	zassert_equal(state.pressed_count, 0);
+}
+
+ZTEST(kb_state, test_report_layout)
+{
+	uint8_t report[KB_REPORT_COUNT];
+
+	zassert_equal(KB_REPORT_COUNT, 8);
+
+	kb_state_build_report(&state, report);
+	for (int i = 0; i < KB_REPORT_COUNT; i++) {
+		zassert_equal(report[i], 0, "byte %d of the idle report", i);
+	}
+
+	zassert_ok(kb_state_process(&state, INPUT_KEY_LEFTCTRL, true));
+	zassert_ok(kb_state_process(&state, INPUT_KEY_A, true));
+	zassert_ok(kb_state_process(&state, INPUT_KEY_ENTER, true));
+
+	kb_state_build_report(&state, report);
+	zassert_equal(report[KB_MOD_KEY], HID_KBD_MODIFIER_LEFT_CTRL);
+	zassert_equal(report[KB_RESERVED], 0);
+	zassert_equal(report[KB_KEY_CODE1], HID_KEY_A);
+	zassert_equal(report[KB_KEY_CODE2], HID_KEY_ENTER);
+	for (int i = KB_KEY_CODE3; i < KB_REPORT_COUNT; i++) {
+		zassert_equal(report[i], 0, "byte %d past the pressed keys", i);
+	}
+}
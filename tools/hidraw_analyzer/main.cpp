@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * hidraw report-rate and jitter analyzer
+ *
+ * Reads input reports from the keyboard's hidraw node, timestamps each
+ * one with CLOCK_MONOTONIC and reports polling rate, inter-report jitter,
+ * unchanged reports and rollover. Live mode prints statistics for every
+ * window, batch mode prints one summary at the end.
+ *
+ * The keyboard report layout depends on the build: with the consumer or
+ * vendor report every report starts with its ID, with NKRO the keys are
+ * a bitmap. --report-id and --nkro select the layout, reports with
+ * other IDs are counted but not timed.
+ */
+
+#include "report_stats.h"
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+constexpr unsigned int kDefaultVid = 0x1209;
+constexpr unsigned int kDefaultPid = 0x0007;
+constexpr std::size_t kMaxReportSize = 64;
+
+volatile std::sig_atomic_t stop_requested;
+
+struct Options {
+	std::string device;
+	unsigned int vid = kDefaultVid;
+	unsigned int pid = kDefaultPid;
+	bool batch = false;
+	double window_s = 1.0;
+	double duration_s = 0.0;
+	std::size_t max_reports = 0;
+	double expected_us = 1000.0;
+	ReportLayout layout;
+	std::string csv;
+};
+
+uint64_t monotonic_ns()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Find the hidraw node of a device by its vendor and product ID */
+std::string find_hidraw(unsigned int vid, unsigned int pid)
+{
+	char hid_id[32];
+	std::error_code ec;
+
+	std::snprintf(hid_id, sizeof(hid_id), "HID_ID=%04X:%08X:%08X",
+		      0x0003, vid, pid);
+
+	for (const auto &entry :
+	     std::filesystem::directory_iterator("/sys/class/hidraw", ec)) {
+		std::ifstream uevent(entry.path() / "device" / "uevent");
+		std::string line;
+
+		while (std::getline(uevent, line)) {
+			if (line == hid_id) {
+				return "/dev/" + entry.path().filename().string();
+			}
+		}
+	}
+
+	return {};
+}
+
+void usage(const char *prog)
+{
+	std::cerr <<
+		"Usage: " << prog << " [options] [/dev/hidrawN]\n"
+		"\n"
+		"Without a device, the hidraw node is looked up by VID:PID.\n"
+		"\n"
+		"  -v, --vid VID        vendor ID (default 0x1209)\n"
+		"  -p, --pid PID        product ID (default 0x0007)\n"
+		"  -b, --batch          print one summary at the end\n"
+		"  -w, --window SEC     live mode statistics window (default 1)\n"
+		"  -d, --duration SEC   stop after SEC seconds\n"
+		"  -n, --count N        stop after N reports\n"
+		"  -e, --expected US    configured polling interval (default 1000)\n"
+		"  -r, --report-id ID   keyboard report ID, for builds with report IDs\n"
+		"  -k, --nkro           keyboard report is the NKRO key bitmap\n"
+		"  -c, --csv FILE       write timestamp and report of every read\n"
+		"  -h, --help           show this help\n";
+}
+
+bool parse_options(int argc, char **argv, Options &opts)
+{
+	static const struct option long_opts[] = {
+		{"vid", required_argument, nullptr, 'v'},
+		{"pid", required_argument, nullptr, 'p'},
+		{"batch", no_argument, nullptr, 'b'},
+		{"window", required_argument, nullptr, 'w'},
+		{"duration", required_argument, nullptr, 'd'},
+		{"count", required_argument, nullptr, 'n'},
+		{"expected", required_argument, nullptr, 'e'},
+		{"report-id", required_argument, nullptr, 'r'},
+		{"nkro", no_argument, nullptr, 'k'},
+		{"csv", required_argument, nullptr, 'c'},
+		{"help", no_argument, nullptr, 'h'},
+		{nullptr, 0, nullptr, 0},
+	};
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "v:p:bw:d:n:e:r:kc:h",
+				  long_opts, nullptr)) != -1) {
+		switch (opt) {
+		case 'v':
+			opts.vid = std::strtoul(optarg, nullptr, 0);
+			break;
+		case 'p':
+			opts.pid = std::strtoul(optarg, nullptr, 0);
+			break;
+		case 'b':
+			opts.batch = true;
+			break;
+		case 'w':
+			opts.window_s = std::strtod(optarg, nullptr);
+			break;
+		case 'd':
+			opts.duration_s = std::strtod(optarg, nullptr);
+			break;
+		case 'n':
+			opts.max_reports = std::strtoul(optarg, nullptr, 0);
+			break;
+		case 'e':
+			opts.expected_us = std::strtod(optarg, nullptr);
+			break;
+		case 'r':
+			opts.layout.report_id = std::strtoul(optarg, nullptr, 0);
+			break;
+		case 'k':
+			opts.layout.nkro = true;
+			break;
+		case 'c':
+			opts.csv = optarg;
+			break;
+		default:
+			return false;
+		}
+	}
+
+	if (optind < argc) {
+		opts.device = argv[optind];
+	}
+
+	return opts.window_s > 0.0;
+}
+
+} /* namespace */
+
+int main(int argc, char **argv)
+{
+	Options opts;
+	std::ofstream csv;
+	uint8_t buf[kMaxReportSize];
+
+	if (!parse_options(argc, argv, opts)) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	ReportStats total(opts.layout);
+	ReportStats window(opts.layout);
+
+	if (opts.device.empty()) {
+		opts.device = find_hidraw(opts.vid, opts.pid);
+		if (opts.device.empty()) {
+			std::fprintf(stderr, "No hidraw device for %04x:%04x\n",
+				     opts.vid, opts.pid);
+			return EXIT_FAILURE;
+		}
+	}
+
+	int fd = open(opts.device.c_str(), O_RDONLY);
+	if (fd < 0) {
+		std::fprintf(stderr, "Failed to open %s: %s\n",
+			     opts.device.c_str(), std::strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	if (!opts.csv.empty()) {
+		csv.open(opts.csv);
+		csv << "t_ns,report\n";
+	}
+
+	std::signal(SIGINT, [](int) { stop_requested = 1; });
+	std::signal(SIGTERM, [](int) { stop_requested = 1; });
+
+	std::cerr << "Reading " << opts.device << ", Ctrl-C to stop\n";
+
+	const uint64_t start_ns = monotonic_ns();
+	const uint64_t window_ns = static_cast<uint64_t>(opts.window_s * 1e9);
+	uint64_t window_end = start_ns + window_ns;
+
+	while (!stop_requested) {
+		struct pollfd pfd = {fd, POLLIN, 0};
+		int ret = poll(&pfd, 1, 100);
+		uint64_t now = monotonic_ns();
+
+		if (ret < 0 && errno != EINTR) {
+			std::perror("poll");
+			break;
+		}
+
+		if (ret > 0) {
+			ssize_t len = read(fd, buf, sizeof(buf));
+
+			/* Timestamp as close to the read as possible */
+			now = monotonic_ns();
+			if (len < 0) {
+				std::perror("read");
+				break;
+			}
+			if (len == 0) {
+				/* Device went away */
+				break;
+			}
+
+			total.add(now, buf, len);
+			window.add(now, buf, len);
+
+			if (csv.is_open()) {
+				csv << now << ",";
+				for (ssize_t i = 0; i < len; i++) {
+					char hex[3];
+
+					std::snprintf(hex, sizeof(hex), "%02x", buf[i]);
+					csv << hex;
+				}
+				csv << "\n";
+			}
+		}
+
+		if (!opts.batch && now >= window_end) {
+			std::cout << "--- " << (now - start_ns) / 1e9 << " s\n";
+			window.print(std::cout, opts.expected_us);
+			window.reset();
+			window_end += window_ns;
+		}
+
+		if ((opts.max_reports && total.count() >= opts.max_reports) ||
+		    (opts.duration_s > 0.0 && now - start_ns >= opts.duration_s * 1e9)) {
+			break;
+		}
+	}
+
+	close(fd);
+
+	std::cout << "=== total\n";
+	total.print(std::cout, opts.expected_us);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Report rate, jitter and content statistics for hidraw input reports
+ */
+
+#include "report_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+
+void ReportStats::add(uint64_t t_ns, const uint8_t *data, std::size_t len)
+{
+	if (layout_.report_id != 0) {
+		/* Consumer and vendor reports share the node, only time the keyboard */
+		if (len == 0 || data[0] != layout_.report_id) {
+			other_++;
+			return;
+		}
+		data++;
+		len--;
+	}
+
+	if (count_ == 0) {
+		first_ns_ = t_ns;
+	} else {
+		intervals_.push_back(t_ns - last_ns_);
+	}
+
+	if (count_ > 0 && prev_.size() == len && std::memcmp(prev_.data(), data, len) == 0) {
+		unchanged_++;
+	}
+
+	if (layout_.nkro && len == kNkroReportSize) {
+		std::size_t pressed = 0;
+
+		/* Usage 0 is no key, the bitmap starts after the modifiers */
+		for (std::size_t i = 1; i < len; i++) {
+			pressed += __builtin_popcount(i == 1 ? data[i] & ~1U : data[i]);
+		}
+		max_keys_ = std::max(max_keys_, pressed);
+	} else if (!layout_.nkro && len == kBootReportSize) {
+		const uint8_t *keys = data + 2;
+		std::size_t pressed = 0;
+
+		if (std::all_of(keys, keys + kBootKeySlots,
+				[](uint8_t k) { return k == kErrorRollOver; })) {
+			rollover_++;
+		} else {
+			pressed = std::count_if(keys, keys + kBootKeySlots,
+						[](uint8_t k) { return k != 0; });
+			max_keys_ = std::max(max_keys_, pressed);
+		}
+	}
+
+	prev_.assign(data, data + len);
+	last_ns_ = t_ns;
+	count_++;
+}
+
+void ReportStats::reset()
+{
+	*this = ReportStats(layout_);
+}
+
+static double percentile(const std::vector<uint64_t> &sorted, double pct)
+{
+	std::size_t idx = static_cast<std::size_t>(sorted.size() * pct / 100.0);
+
+	return sorted[std::min(idx, sorted.size() - 1)] / 1e3;
+}
+
+void ReportStats::print(std::ostream &os, double expected_us) const
+{
+	os << std::fixed << std::setprecision(1);
+	os << "reports:        " << count_ << " (" << unchanged_
+	   << " unchanged, " << rollover_ << " rollover)\n";
+	os << "max keys down:  " << max_keys_ << "\n";
+	if (layout_.report_id != 0) {
+		os << "other reports:  " << other_ << "\n";
+	}
+
+	if (intervals_.empty()) {
+		return;
+	}
+
+	std::vector<uint64_t> sorted(intervals_);
+	std::sort(sorted.begin(), sorted.end());
+
+	double span_s = (last_ns_ - first_ns_) / 1e9;
+	double mean = 0.0;
+	double var = 0.0;
+
+	for (uint64_t v : intervals_) {
+		mean += v / 1e3;
+	}
+	mean /= intervals_.size();
+	for (uint64_t v : intervals_) {
+		var += (v / 1e3 - mean) * (v / 1e3 - mean);
+	}
+	var /= intervals_.size();
+
+	os << "report rate:    " << (count_ - 1) / span_s << " reports/s\n";
+	os << "interval (us):  min " << sorted.front() / 1e3
+	   << " p50 " << percentile(sorted, 50)
+	   << " p99 " << percentile(sorted, 99)
+	   << " max " << sorted.back() / 1e3
+	   << " mean " << mean << "\n";
+	os << "jitter (us):    stddev " << std::sqrt(var)
+	   << " p99-p50 " << percentile(sorted, 99) - percentile(sorted, 50)
+	   << "\n";
+	/* The shortest interval bounds the host polling period from above */
+	os << "effective poll: <= " << sorted.front() / 1e3 << " us ("
+	   << 1e9 / sorted.front() << " Hz)\n";
+
+	if (expected_us > 0.0) {
+		std::size_t on_time = 0;
+		std::size_t late = 0;
+
+		for (uint64_t v : intervals_) {
+			double polls = v / 1e3 / expected_us;
+
+			if (polls < 1.5) {
+				on_time++;
+			} else if (polls < 2.5) {
+				late++;
+			}
+		}
+
+		os << "vs " << expected_us << " us poll: " << on_time
+		   << " back-to-back, " << late << " one poll late, "
+		   << intervals_.size() - on_time - late << " idle gaps\n";
+	}
+}
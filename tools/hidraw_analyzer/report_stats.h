@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Report rate, jitter and content statistics for hidraw input reports
+ */
+
+#ifndef HIDRAW_ANALYZER_REPORT_STATS_H
+#define HIDRAW_ANALYZER_REPORT_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/* Boot keyboard report layout, as sent by the firmware */
+constexpr std::size_t kBootReportSize = 8;
+constexpr std::size_t kBootKeySlots = 6;
+/* Usage placed in every key slot when more keys are down than fit */
+constexpr uint8_t kErrorRollOver = 0x01;
+/* NKRO keyboard report: modifiers and a bitmap of usages 0 to 0x7f */
+constexpr std::size_t kNkroReportSize = 17;
+
+/* Keyboard report layout of the build under test */
+struct ReportLayout {
+	/* Report ID of the keyboard report, 0 if the device uses no IDs */
+	uint8_t report_id = 0;
+	/* Key bitmap instead of the boot layout key array */
+	bool nkro = false;
+};
+
+class ReportStats {
+public:
+	explicit ReportStats(const ReportLayout &layout = {}) : layout_(layout) {}
+
+	/*
+	 * Add one input report.
+	 *
+	 * @param t_ns CLOCK_MONOTONIC time the report was read, in ns
+	 * @param data Report contents
+	 * @param len Report length in bytes
+	 */
+	void add(uint64_t t_ns, const uint8_t *data, std::size_t len);
+
+	/* Forget all reports but keep the layout, used between live mode windows */
+	void reset();
+
+	/*
+	 * Print a summary of the reports seen so far.
+	 *
+	 * @param os Output stream
+	 * @param expected_us Configured polling interval to compare against,
+	 *                    0 to skip missed-poll estimation
+	 */
+	void print(std::ostream &os, double expected_us) const;
+
+	std::size_t count() const { return count_; }
+
+private:
+	ReportLayout layout_;
+	std::size_t count_ = 0;
+	/* Reports with another report ID, not counted otherwise */
+	std::size_t other_ = 0;
+	std::size_t unchanged_ = 0;
+	std::size_t rollover_ = 0;
+	std::size_t max_keys_ = 0;
+	uint64_t first_ns_ = 0;
+	uint64_t last_ns_ = 0;
+	std::vector<uint8_t> prev_;
+	/* Inter-report intervals, in ns */
+	std::vector<uint64_t> intervals_;
+};
+
+#endif /* HIDRAW_ANALYZER_REPORT_STATS_H */
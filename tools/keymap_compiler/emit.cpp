@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * C header generation for compiled layouts
+ *
+ * Layer tables are padded to a multiple of 16 actions so every layer
+ * starts on a 32-byte cache line, making a lookup one indexed load.
+ *
+ * Leader sequences become a double-array trie: the usages that occur in
+ * sequences are numbered 1..n, and the child of node s for code c sits
+ * at slot base[s] + c if check[base[s] + c] == s. A keystroke is one
+ * load of the code and one of the node, whatever the number of
+ * sequences. Slot 0 is the root. Without sequences neither table is
+ * emitted.
+ */
+
+#include "emit.h"
+#include "keycodes.h"
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr unsigned int kStrideAlign = 16;
+constexpr uint16_t kLeaderFree = 0xffff;
+
+struct TrieNode {
+	uint16_t base = 0;
+	uint16_t check = kLeaderFree;
+	uint16_t action = kActionNone;
+};
+
+struct LeaderTrie {
+	/* Usage to code, 0 for usages in no sequence */
+	std::vector<uint8_t> codes = std::vector<uint8_t>(kUsageLeftCtrl, 0);
+	std::vector<TrieNode> nodes = std::vector<TrieNode>(1);
+};
+
+/* Pointer trie, only used while placing the nodes */
+struct BuildNode {
+	std::map<uint8_t, BuildNode> children;
+	uint16_t action = kActionNone;
+};
+
+LeaderTrie build_leader_trie(const std::vector<Leader> &leaders)
+{
+	LeaderTrie trie;
+	BuildNode root;
+	uint8_t next_code = 1;
+	std::vector<std::pair<const BuildNode *, uint16_t>> queue = {{&root, 0}};
+
+	for (const Leader &leader : leaders) {
+		BuildNode *node = &root;
+
+		for (uint8_t usage : leader.usages) {
+			if (trie.codes[usage] == 0) {
+				trie.codes[usage] = next_code++;
+			}
+			node = &node->children[trie.codes[usage]];
+		}
+		node->action = leader.action;
+	}
+
+	/* Breadth first, each node takes the lowest base its children fit at */
+	for (std::size_t q = 0; q < queue.size(); q++) {
+		const auto [node, slot] = queue[q];
+		unsigned int base = 1;
+		auto fits = [&trie, node](unsigned int b) {
+			for (const auto &child : node->children) {
+				unsigned int s = b + child.first;
+
+				if (s < trie.nodes.size() && trie.nodes[s].check != kLeaderFree) {
+					return false;
+				}
+			}
+			return true;
+		};
+
+		trie.nodes[slot].action = node->action;
+		if (node->children.empty()) {
+			continue;
+		}
+
+		while (!fits(base)) {
+			base++;
+		}
+		if (base + node->children.rbegin()->first >= kLeaderFree) {
+			throw LayoutError("leader sequences do not fit the trie");
+		}
+
+		trie.nodes[slot].base = base;
+		for (const auto &[code, child] : node->children) {
+			unsigned int s = base + code;
+
+			if (s >= trie.nodes.size()) {
+				trie.nodes.resize(s + 1);
+			}
+			trie.nodes[s].check = slot;
+			queue.emplace_back(&child, s);
+		}
+	}
+
+	return trie;
+}
+
+std::string hex(unsigned int v, int digits)
+{
+	char buf[16];
+
+	std::snprintf(buf, sizeof(buf), "0x%0*x", digits, v);
+
+	return buf;
+}
+
+} /* namespace */
+
+void emit_header(const Layout &layout, std::ostream &os)
+{
+	unsigned int stride = (layout.keys() + kStrideAlign - 1) / kStrideAlign * kStrideAlign;
+	LeaderTrie trie = build_leader_trie(layout.leaders);
+
+	os << "/*\n"
+	   << " * Generated by keymap_compiler from " << layout.source << "\n"
+	   << " * Do not edit, change the layout file instead.\n"
+	   << " */\n\n"
+	   << "#ifndef KB_KEYMAP_GENERATED_H\n"
+	   << "#define KB_KEYMAP_GENERATED_H\n\n"
+	   << "#define KB_KEYMAP_ROWS " << layout.rows << "\n"
+	   << "#define KB_KEYMAP_COLS " << layout.cols << "\n"
+	   << "#define KB_KEYMAP_KEYS " << layout.keys() << "\n"
+	   << "#define KB_KEYMAP_STRIDE " << stride << "\n"
+	   << "#define KB_KEYMAP_LAYERS " << layout.layers.size() << "\n"
+	   << "#define KB_KEYMAP_LEADER_COUNT " << layout.leaders.size() << "\n"
+	   << "#define KB_KEYMAP_LEADER_NODES " << trie.nodes.size() << "\n"
+	   << "#define KB_KEYMAP_LEADER_CODES " << hex(trie.codes.size(), 2) << "\n"
+	   << "#define KB_KEYMAP_LEADER_TIMEOUT_MS " << layout.leader_timeout_ms << "\n"
+	   << "#define KB_KEYMAP_MAX_USAGE " << hex(layout.max_usage(), 2) << "\n"
+	   << "#define KB_KEYMAP_ACTION_TYPES " << hex(layout.action_types(), 4) << "\n\n";
+
+	/* The tables use C designated initializers, C++ only gets the constants */
+	os << "#ifndef __cplusplus\n\n";
+
+	os << "static const uint16_t kb_keymap_layers[KB_KEYMAP_LAYERS][KB_KEYMAP_STRIDE]\n"
+	   << "\t__aligned(32) = {\n";
+	for (std::size_t l = 0; l < layout.layers.size(); l++) {
+		const Layer &layer = layout.layers[l];
+
+		os << "\t[" << l << "] = { /* " << layer.name << " */\n";
+		for (unsigned int r = 0; r < layout.rows; r++) {
+			os << "\t\t";
+			for (unsigned int c = 0; c < layout.cols; c++) {
+				os << hex(layer.actions[r * layout.cols + c], 4)
+				   << (c + 1 < layout.cols ? ", " : ",\n");
+			}
+		}
+		os << "\t},\n";
+	}
+	os << "};\n\n";
+
+	if (!layout.leaders.empty()) {
+		os << "static const uint8_t kb_keymap_leader_codes[KB_KEYMAP_LEADER_CODES] = {\n";
+		for (std::size_t usage = 0; usage < trie.codes.size(); usage++) {
+			if (trie.codes[usage] != 0) {
+				os << "\t[" << hex(usage, 2) << "] = "
+				   << unsigned(trie.codes[usage]) << ",\n";
+			}
+		}
+		os << "};\n\n";
+
+		os << "static const struct kb_keymap_leader_node "
+		   << "kb_keymap_leader_trie[KB_KEYMAP_LEADER_NODES] = {\n";
+		for (std::size_t s = 0; s < trie.nodes.size(); s++) {
+			const TrieNode &node = trie.nodes[s];
+
+			os << "\t[" << s << "] = { .base = " << node.base
+			   << ", .check = " << hex(node.check, 4)
+			   << ", .action = " << hex(node.action, 4) << " },\n";
+		}
+		os << "};\n\n";
+	}
+
+	os << "#endif /* !__cplusplus */\n\n"
+	   << "#endif /* KB_KEYMAP_GENERATED_H */\n";
+}
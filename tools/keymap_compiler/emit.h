@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * C header generation for compiled layouts
+ */
+
+#ifndef KEYMAP_COMPILER_EMIT_H
+#define KEYMAP_COMPILER_EMIT_H
+
+#include "layout.h"
+
+#include <ostream>
+
+/* Write the generated tables for a layout */
+void emit_header(const Layout &layout, std::ostream &os);
+
+#endif /* KEYMAP_COMPILER_EMIT_H */
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Key names accepted in layout files and their HID usages
+ * (Keyboard/Keypad page 0x07)
+ */
+
+#ifndef KEYMAP_COMPILER_KEYCODES_H
+#define KEYMAP_COMPILER_KEYCODES_H
+
+#include <cstdint>
+#include <string_view>
+
+struct Keycode {
+	std::string_view name;
+	uint8_t usage;
+};
+
+inline constexpr Keycode kKeycodes[] = {
+	{"A", 0x04}, {"B", 0x05}, {"C", 0x06}, {"D", 0x07}, {"E", 0x08},
+	{"F", 0x09}, {"G", 0x0a}, {"H", 0x0b}, {"I", 0x0c}, {"J", 0x0d},
+	{"K", 0x0e}, {"L", 0x0f}, {"M", 0x10}, {"N", 0x11}, {"O", 0x12},
+	{"P", 0x13}, {"Q", 0x14}, {"R", 0x15}, {"S", 0x16}, {"T", 0x17},
+	{"U", 0x18}, {"V", 0x19}, {"W", 0x1a}, {"X", 0x1b}, {"Y", 0x1c},
+	{"Z", 0x1d},
+	{"1", 0x1e}, {"2", 0x1f}, {"3", 0x20}, {"4", 0x21}, {"5", 0x22},
+	{"6", 0x23}, {"7", 0x24}, {"8", 0x25}, {"9", 0x26}, {"0", 0x27},
+	{"ENTER", 0x28}, {"ESC", 0x29}, {"BSPC", 0x2a}, {"TAB", 0x2b},
+	{"SPC", 0x2c}, {"MINS", 0x2d}, {"EQL", 0x2e}, {"LBRC", 0x2f},
+	{"RBRC", 0x30}, {"BSLS", 0x31}, {"SCLN", 0x33}, {"QUOT", 0x34},
+	{"GRV", 0x35}, {"COMM", 0x36}, {"DOT", 0x37}, {"SLSH", 0x38},
+	{"CAPS", 0x39},
+	{"F1", 0x3a}, {"F2", 0x3b}, {"F3", 0x3c}, {"F4", 0x3d}, {"F5", 0x3e},
+	{"F6", 0x3f}, {"F7", 0x40}, {"F8", 0x41}, {"F9", 0x42}, {"F10", 0x43},
+	{"F11", 0x44}, {"F12", 0x45},
+	{"PSCR", 0x46}, {"SLCK", 0x47}, {"PAUS", 0x48}, {"INS", 0x49},
+	{"HOME", 0x4a}, {"PGUP", 0x4b}, {"DEL", 0x4c}, {"END", 0x4d},
+	{"PGDN", 0x4e}, {"RGHT", 0x4f}, {"LEFT", 0x50}, {"DOWN", 0x51},
+	{"UP", 0x52},
+	{"NLCK", 0x53}, {"PSLS", 0x54}, {"PAST", 0x55}, {"PMNS", 0x56},
+	{"PPLS", 0x57}, {"PENT", 0x58}, {"P1", 0x59}, {"P2", 0x5a},
+	{"P3", 0x5b}, {"P4", 0x5c}, {"P5", 0x5d}, {"P6", 0x5e}, {"P7", 0x5f},
+	{"P8", 0x60}, {"P9", 0x61}, {"P0", 0x62}, {"PDOT", 0x63},
+	{"APP", 0x65},
+	{"F13", 0x68}, {"F14", 0x69}, {"F15", 0x6a}, {"F16", 0x6b},
+	{"F17", 0x6c}, {"F18", 0x6d}, {"F19", 0x6e}, {"F20", 0x6f},
+	{"F21", 0x70}, {"F22", 0x71}, {"F23", 0x72}, {"F24", 0x73},
+	{"LCTL", 0xe0}, {"LSFT", 0xe1}, {"LALT", 0xe2}, {"LGUI", 0xe3},
+	{"RCTL", 0xe4}, {"RSFT", 0xe5}, {"RALT", 0xe6}, {"RGUI", 0xe7},
+};
+
+/* First and last modifier usage */
+inline constexpr uint8_t kUsageLeftCtrl = 0xe0;
+inline constexpr uint8_t kUsageRightGui = 0xe7;
+
+#endif /* KEYMAP_COMPILER_KEYCODES_H */
@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Layout description parser and validator
+ *
+ * Format, one statement per line, '#' starts a comment:
+ *
+ *   matrix <rows> <cols>
+ *   layer <name>          followed by <rows> lines of <cols> actions
+ *   end
+ *   leader <key>... = <action>
+ *   leader-timeout <ms>
+ *
+ * Actions are key names (see keycodes.h), "_" (transparent, falls
+ * through to lower layers), "---" (no action), MO(<layer>) (momentary
+ * layer), LEAD (starts a leader sequence), DM_REC and DM_PLAY (record
+ * and replay the dynamic macro) and SCAN_FREEZE (freeze the raw scan
+ * history). Leader sequences are the keys typed after LEAD, none may be
+ * a prefix of another so a sequence fires on its last key.
+ *
+ * The firmware keymap has no tap-hold, macro or combo handling, so
+ * TH(), M() and the tapping-term, macro and combo statements are
+ * rejected rather than compiled into tables nothing reads.
+ */
+
+#include "layout.h"
+#include "keycodes.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <sstream>
+
+namespace {
+
+struct RawLayer {
+	std::string name;
+	unsigned int line;
+	std::vector<std::pair<std::string, unsigned int>> tokens;
+};
+
+struct RawLeader {
+	std::vector<std::string> keys;
+	std::string action;
+	unsigned int line;
+};
+
+class Parser {
+public:
+	explicit Parser(const std::string &path) : path_(path) {}
+
+	Layout run();
+
+private:
+	[[noreturn]] void fail(unsigned int line, const std::string &msg) const
+	{
+		throw LayoutError(path_ + ":" + std::to_string(line) + ": " + msg);
+	}
+
+	unsigned int number(const std::string &tok, unsigned int line) const;
+	uint16_t action(const std::string &tok, unsigned int line, bool base);
+	uint8_t key(const std::string &tok, unsigned int line) const;
+	void resolve(Layout &layout);
+
+	std::string path_;
+	std::vector<RawLayer> raw_layers_;
+	std::vector<RawLeader> raw_leaders_;
+	std::map<std::string, unsigned int> layer_index_;
+	/* Line of the first LEAD, 0 if there is none */
+	unsigned int lead_line_ = 0;
+};
+
+std::optional<uint8_t> lookup_key(const std::string &name)
+{
+	for (const Keycode &kc : kKeycodes) {
+		if (kc.name == name) {
+			return kc.usage;
+		}
+	}
+
+	return std::nullopt;
+}
+
+/* Split "NAME(a,b)" into NAME and its arguments */
+bool split_call(const std::string &tok, std::string &fn, std::vector<std::string> &args)
+{
+	std::size_t open = tok.find('(');
+
+	if (open == std::string::npos || tok.back() != ')') {
+		return false;
+	}
+
+	fn = tok.substr(0, open);
+	args.clear();
+
+	std::stringstream ss(tok.substr(open + 1, tok.size() - open - 2));
+	std::string arg;
+
+	while (std::getline(ss, arg, ',')) {
+		args.push_back(arg);
+	}
+
+	return true;
+}
+
+} /* namespace */
+
+uint8_t Layout::max_usage() const
+{
+	uint8_t max = 0;
+	auto consider = [&max](uint8_t usage) {
+		if (usage < kUsageLeftCtrl) {
+			max = std::max(max, usage);
+		}
+	};
+
+	for (const Layer &layer : layers) {
+		for (uint16_t a : layer.actions) {
+			if (a >> 12 == static_cast<uint16_t>(ActionType::Key)) {
+				consider(a & 0xff);
+			}
+		}
+	}
+	for (const Leader &leader : leaders) {
+		if (leader.action >> 12 == static_cast<uint16_t>(ActionType::Key)) {
+			consider(leader.action & 0xff);
+		}
+	}
+
+	return max;
+}
+
+uint16_t Layout::action_types() const
+{
+	/* Empty positions resolve to KB_ACTION_NONE, a key action */
+	uint16_t types = 1U << static_cast<uint16_t>(ActionType::Key);
+
+	for (const Layer &layer : layers) {
+		for (uint16_t a : layer.actions) {
+			types |= 1U << (a >> 12);
+		}
+	}
+	for (const Leader &leader : leaders) {
+		types |= 1U << (leader.action >> 12);
+	}
+
+	return types;
+}
+
+unsigned int Parser::number(const std::string &tok, unsigned int line) const
+{
+	try {
+		std::size_t used;
+		unsigned long v = std::stoul(tok, &used, 0);
+
+		if (used == tok.size()) {
+			return static_cast<unsigned int>(v);
+		}
+	} catch (const std::exception &) {
+	}
+
+	fail(line, "expected a number, got '" + tok + "'");
+}
+
+uint8_t Parser::key(const std::string &tok, unsigned int line) const
+{
+	std::optional<uint8_t> usage = lookup_key(tok);
+
+	if (!usage) {
+		fail(line, "unknown key '" + tok + "'");
+	}
+
+	return *usage;
+}
+
+uint16_t Parser::action(const std::string &tok, unsigned int line, bool base)
+{
+	std::string fn;
+	std::vector<std::string> args;
+
+	if (tok == "_") {
+		if (base) {
+			fail(line, "transparent action in the base layer");
+		}
+		return kActionTrans;
+	}
+
+	if (tok == "---") {
+		return kActionNone;
+	}
+
+	if (tok == "LEAD") {
+		if (lead_line_ == 0) {
+			lead_line_ = line;
+		}
+		return make_action(ActionType::Leader, 0);
+	}
+
+	if (tok == "DM_REC" || tok == "DM_PLAY") {
+		return make_action(ActionType::DynMacro, tok == "DM_PLAY");
+	}
+
+	if (tok == "SCAN_FREEZE") {
+		return make_action(ActionType::ScanFreeze, 0);
+	}
+
+	if (!split_call(tok, fn, args)) {
+		return make_action(ActionType::Key, key(tok, line));
+	}
+
+	if (fn == "MO" && args.size() == 1) {
+		auto it = layer_index_.find(args[0]);
+
+		if (it == layer_index_.end()) {
+			fail(line, "unknown layer '" + args[0] + "'");
+		}
+		if (it->second == 0) {
+			fail(line, "MO() cannot target the base layer");
+		}
+		return make_action(ActionType::Layer, it->second);
+	}
+
+	if (fn == "TH" || fn == "M") {
+		fail(line, fn + "() is not supported by the firmware keymap");
+	}
+
+	fail(line, "invalid action '" + tok + "'");
+}
+
+void Parser::resolve(Layout &layout)
+{
+	if (layout.keys() == 0) {
+		fail(1, "missing 'matrix <rows> <cols>' statement");
+	}
+	if (raw_layers_.empty()) {
+		fail(1, "no layers defined");
+	}
+	if (raw_layers_.size() > kMaxLayers) {
+		fail(raw_layers_[kMaxLayers].line,
+		     "more than " + std::to_string(kMaxLayers) + " layers");
+	}
+
+	for (std::size_t i = 0; i < raw_layers_.size(); i++) {
+		const RawLayer &raw = raw_layers_[i];
+		Layer layer{raw.name, {}};
+
+		if (raw.tokens.size() != layout.keys()) {
+			fail(raw.line, "layer '" + raw.name + "' has " +
+			     std::to_string(raw.tokens.size()) + " actions, expected " +
+			     std::to_string(layout.keys()));
+		}
+
+		for (const auto &[tok, line] : raw.tokens) {
+			layer.actions.push_back(action(tok, line, i == 0));
+		}
+		layout.layers.push_back(std::move(layer));
+	}
+
+	for (const RawLeader &raw : raw_leaders_) {
+		Leader leader;
+
+		if (raw.keys.size() > kMaxLeaderKeys) {
+			fail(raw.line, "leader sequences have at most " +
+			     std::to_string(kMaxLeaderKeys) + " keys");
+		}
+
+		for (const std::string &name : raw.keys) {
+			uint8_t usage = key(name, raw.line);
+
+			if (usage >= kUsageLeftCtrl) {
+				fail(raw.line, "modifier '" + name + "' in a leader sequence");
+			}
+			leader.usages.push_back(usage);
+		}
+
+		for (const Leader &other : layout.leaders) {
+			std::size_t n = std::min(other.usages.size(), leader.usages.size());
+
+			if (std::equal(other.usages.begin(), other.usages.begin() + n,
+				       leader.usages.begin())) {
+				fail(raw.line, "leader sequence is a prefix of another, or the same");
+			}
+		}
+
+		leader.action = action(raw.action, raw.line, true);
+		if (leader.action == kActionNone ||
+		    leader.action >> 12 == static_cast<uint16_t>(ActionType::Leader)) {
+			fail(raw.line, "invalid leader action '" + raw.action + "'");
+		}
+		layout.leaders.push_back(std::move(leader));
+	}
+
+	if (lead_line_ != 0 && layout.leaders.empty()) {
+		fail(lead_line_, "LEAD without leader sequences");
+	}
+}
+
+Layout Parser::run()
+{
+	std::ifstream in(path_);
+	Layout layout;
+	RawLayer *current = nullptr;
+	unsigned int rows_in_layer = 0;
+	std::string text;
+	unsigned int line = 0;
+
+	if (!in) {
+		throw LayoutError(path_ + ": cannot open");
+	}
+
+	layout.source = path_;
+
+	while (std::getline(in, text)) {
+		std::vector<std::string> toks;
+		std::string tok;
+
+		line++;
+		text = text.substr(0, text.find('#'));
+		std::istringstream ss(text);
+		while (ss >> tok) {
+			toks.push_back(tok);
+		}
+		if (toks.empty()) {
+			continue;
+		}
+
+		if (current != nullptr) {
+			if (toks[0] == "end") {
+				if (rows_in_layer != layout.rows) {
+					fail(line, "layer '" + current->name + "' has " +
+					     std::to_string(rows_in_layer) + " rows, expected " +
+					     std::to_string(layout.rows));
+				}
+				current = nullptr;
+				continue;
+			}
+			if (toks.size() != layout.cols) {
+				fail(line, "row has " + std::to_string(toks.size()) +
+				     " actions, expected " + std::to_string(layout.cols));
+			}
+			for (const std::string &t : toks) {
+				current->tokens.emplace_back(t, line);
+			}
+			rows_in_layer++;
+			continue;
+		}
+
+		if (toks[0] == "matrix" && toks.size() == 3) {
+			layout.rows = number(toks[1], line);
+			layout.cols = number(toks[2], line);
+			if (layout.keys() == 0 || layout.keys() > 0x0fff) {
+				fail(line, "invalid matrix size");
+			}
+		} else if (toks[0] == "leader-timeout" && toks.size() == 2) {
+			layout.leader_timeout_ms = number(toks[1], line);
+		} else if (toks[0] == "layer" && toks.size() == 2) {
+			if (layout.keys() == 0) {
+				fail(line, "'matrix' must come before the first layer");
+			}
+			if (!layer_index_.emplace(toks[1], raw_layers_.size()).second) {
+				fail(line, "duplicate layer '" + toks[1] + "'");
+			}
+			raw_layers_.push_back({toks[1], line, {}});
+			current = &raw_layers_.back();
+			rows_in_layer = 0;
+		} else if (toks[0] == "tapping-term" || toks[0] == "macro" ||
+			   toks[0] == "combo") {
+			fail(line, "'" + toks[0] + "' is not supported by the firmware keymap");
+		} else if (toks[0] == "leader" && toks.size() >= 4 &&
+			   toks[toks.size() - 2] == "=") {
+			raw_leaders_.push_back({{toks.begin() + 1, toks.end() - 2},
+						toks.back(), line});
+		} else {
+			fail(line, "invalid statement '" + toks[0] + "'");
+		}
+	}
+
+	if (current != nullptr) {
+		fail(line, "missing 'end' for layer '" + current->name + "'");
+	}
+
+	resolve(layout);
+
+	return layout;
+}
+
+Layout parse_layout(const std::string &path)
+{
+	return Parser(path).run();
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Layout description parser and validator
+ */
+
+#ifndef KEYMAP_COMPILER_LAYOUT_H
+#define KEYMAP_COMPILER_LAYOUT_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Packed 16-bit action, must match src/kb_keymap.h:
+ * bits 15..12 action type, bits 11..0 parameter.
+ */
+enum class ActionType : uint16_t {
+	Key = 0x0,
+	Layer = 0x1,
+	/* 0x2 and 0x3 are kept for tap-hold keys and macros */
+	Leader = 0x4,
+	DynMacro = 0x5,
+	ScanFreeze = 0x6,
+};
+
+constexpr uint16_t kActionNone = 0x0000;
+constexpr uint16_t kActionTrans = 0x0001;
+constexpr unsigned int kMaxLayers = 16;
+constexpr unsigned int kMaxLeaderKeys = 8;
+
+constexpr uint16_t make_action(ActionType type, uint16_t param)
+{
+	return static_cast<uint16_t>(static_cast<uint16_t>(type) << 12 | (param & 0x0fff));
+}
+
+struct Leader {
+	std::vector<uint8_t> usages;
+	uint16_t action;
+};
+
+struct Layer {
+	std::string name;
+	std::vector<uint16_t> actions;
+};
+
+struct Layout {
+	std::string source;
+	unsigned int rows = 0;
+	unsigned int cols = 0;
+	unsigned int leader_timeout_ms = 1000;
+	std::vector<Layer> layers;
+	std::vector<Leader> leaders;
+
+	unsigned int keys() const { return rows * cols; }
+	/* Highest key usage any action can send, for the report descriptor */
+	uint8_t max_usage() const;
+	/* Bit n set if an action of ActionType n can be resolved */
+	uint16_t action_types() const;
+};
+
+class LayoutError : public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
+};
+
+/*
+ * Parse and validate a layout file.
+ *
+ * @throws LayoutError with a "file:line: message" description
+ */
+Layout parse_layout(const std::string &path);
+
+#endif /* KEYMAP_COMPILER_LAYOUT_H */
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2026 Lawrence Langat <lawrencelangatmi@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Keymap compiler
+ *
+ * Reads a layout description, validates it and writes a C header with
+ * the packed action tables and the highest key usage for the HID
+ * report descriptor.
+ *
+ *   keymap_compiler <layout> <output header>
+ */
+
+#include "emit.h"
+#include "layout.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+int main(int argc, char **argv)
+{
+	if (argc != 3) {
+		std::cerr << "Usage: " << argv[0] << " <layout> <output header>\n";
+		return EXIT_FAILURE;
+	}
+
+	try {
+		Layout layout = parse_layout(argv[1]);
+		std::ostringstream header;
+
+		emit_header(layout, header);
+
+		/* Only write complete output so a failed run leaves no header */
+		std::ofstream out(argv[2]);
+		out << header.str();
+		if (!out) {
+			std::cerr << argv[2] << ": write failed\n";
+			return EXIT_FAILURE;
+		}
+	} catch (const LayoutError &e) {
+		std::cerr << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}